@@ -0,0 +1,398 @@
+// Allocator throughput benchmark on synthetic workloads.
+//
+// Every combination of size distribution (uniform, power-law, bimodal)
+// and free order (LIFO, FIFO, random) generates one event stream: mallocs
+// until `live` objects exist, then alternating free/malloc so the live set
+// stays at that size. Each allocator (FF, BF, WF, TLSF, Buddy, Slab)
+// replays the same stream twice on a fresh instance: once untimed per op
+// for ops/sec, once with a timer around every call for p50/p99 latency.
+// Peak metadata is the most host memory the allocator held at once
+// (counted by the operator new below); fragmentation is taken at the end
+// of the steady state. Results go to stdout as JSON.
+//
+// usage: alloc_bench [--events N] [--live N] [--heap BYTES] [--seed N]
+//                    [--min-size N] [--max-size N]
+//                    [--sizes uniform|powerlaw|bimodal|all]
+//                    [--order lifo|fifo|random|all]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "../include/memory.h"
+#include "../include/buddy.h"
+#include "../include/slab.h"
+
+using namespace std;
+
+// Host heap accounting: every operator new carries a size header.
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+static const size_t HEADER = 16;     // keeps the returned pointer 16-byte aligned
+
+void *operator new(size_t n) {
+    char *p = (char *)malloc(n + HEADER);
+    if (!p) throw bad_alloc();
+    memcpy(p, &n, sizeof n);
+    live_bytes += n;
+    if (live_bytes > peak_bytes) peak_bytes = live_bytes;
+    return p + HEADER;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (!ptr) return;
+    char *p = (char *)((uintptr_t)ptr - HEADER);
+    size_t n;
+    memcpy(&n, p, sizeof n);
+    live_bytes -= n;
+    free(p);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+enum SizeDist { UNIFORM, POWER_LAW, BIMODAL };
+enum FreeOrder { LIFO, FIFO, RANDOM_ORDER };
+enum AllocKind { A_FF, A_BF, A_WF, A_TLSF, A_BUDDY, A_SLAB, ALLOC_COUNT };
+
+static const char *dist_names[] = { "uniform", "powerlaw", "bimodal" };
+static const char *order_names[] = { "lifo", "fifo", "random" };
+static const char *alloc_names[] = { "FF", "BF", "WF", "TLSF", "Buddy", "Slab" };
+
+struct Config {
+    long long events = 2000000;
+    int live = 4000;
+    int heap = 1 << 24;
+    int min_size = 16;
+    int max_size = 4096;
+    unsigned seed = 42;
+    vector<SizeDist> dists = { UNIFORM, POWER_LAW, BIMODAL };
+    vector<FreeOrder> orders = { LIFO, FIFO, RANDOM_ORDER };
+};
+
+// One event: a malloc of `value` bytes, or a free of object `value`
+// (objects are numbered by the malloc that created them).
+struct Op {
+    bool is_free;
+    int value;
+};
+
+static int draw_size(SizeDist dist, const Config &cfg, mt19937 &rng) {
+    uniform_real_distribution<double> u(0.0, 1.0);
+    double lo = cfg.min_size, hi = cfg.max_size;
+
+    switch (dist) {
+        case UNIFORM:
+            return uniform_int_distribution<int>(cfg.min_size, cfg.max_size)(rng);
+
+        case POWER_LAW: {
+            // P(size) ~ size^-2 on [min, max], by inverting the CDF.
+            double a = 1.0 / lo, b = 1.0 / hi;
+            return (int)min(hi, 1.0 / (a - u(rng) * (a - b)));
+        }
+
+        case BIMODAL:
+            // 90% small objects from the bottom sixteenth of the range,
+            // 10% large ones from the top half.
+            if (u(rng) < 0.9)
+                return (int)(lo + u(rng) * max(0.0, hi / 16 - lo));
+            return (int)(hi / 2 + u(rng) * hi / 2);
+    }
+    return cfg.min_size;
+}
+
+static vector<Op> generate(SizeDist dist, FreeOrder order, const Config &cfg) {
+    mt19937 rng(cfg.seed);
+    vector<Op> ops;
+    ops.reserve(cfg.events);
+
+    // Live objects; LIFO pops the back, FIFO advances `oldest`, random
+    // swaps the chosen object to the back first.
+    vector<int> live;
+    size_t oldest = 0;
+    int objects = 0;
+
+    while ((long long)ops.size() < cfg.events) {
+        if ((int)(live.size() - oldest) < cfg.live) {
+            ops.push_back({false, draw_size(dist, cfg, rng)});
+            live.push_back(objects++);
+            continue;
+        }
+
+        int victim;
+        if (order == FIFO) {
+            victim = live[oldest++];
+            if (oldest > live.size() / 2) {
+                live.erase(live.begin(), live.begin() + oldest);
+                oldest = 0;
+            }
+        }
+        else {
+            if (order == RANDOM_ORDER) {
+                size_t i = oldest + rng() % (live.size() - oldest);
+                swap(live[i], live.back());
+            }
+            victim = live.back();
+            live.pop_back();
+        }
+        ops.push_back({true, victim});
+    }
+    return ops;
+}
+
+// The allocator under test behind one malloc/free interface.
+struct Subject {
+    AllocKind kind;
+    unique_ptr<LinearAllocator> linear;
+    unique_ptr<BuddyAllocator> buddy;
+    unique_ptr<SlabAllocator> slab;
+
+    Subject(AllocKind kind, int heap) : kind(kind) {
+        if (kind == A_BUDDY || kind == A_SLAB)
+            buddy.reset(new BuddyAllocator(heap, 128));
+        if (kind == A_SLAB)
+            slab.reset(new SlabAllocator(*buddy, 128));
+        if (kind <= A_TLSF)
+            linear.reset(new LinearAllocator(heap));
+    }
+
+    int allocate(int size) {
+        switch (kind) {
+            case A_FF:    return linear->malloc_first_fit(size);
+            case A_BF:    return linear->malloc_best_fit(size);
+            case A_WF:    return linear->malloc_worst_fit(size);
+            case A_TLSF:  return linear->malloc_tlsf(size);
+            case A_BUDDY: return buddy->buddy_malloc(size);
+            default:      return slab->slab_malloc(size);
+        }
+    }
+
+    void release(int addr) {
+        if (kind <= A_TLSF)      linear->free_block(addr);
+        else if (kind == A_SLAB) slab->slab_free(addr);
+        else                     buddy->buddy_free(addr);
+    }
+
+    int internal_fragmentation() const {
+        if (kind <= A_TLSF)      return linear->internal_fragmentation();
+        if (kind == A_SLAB)      return slab->get_internal_fragmentation();
+        return buddy->get_internal_fragmentation();
+    }
+
+    // The buddy allocator does not track it, as in the compare table.
+    int external_fragmentation() const {
+        if (kind <= A_TLSF)      return linear->external_fragmentation();
+        if (kind == A_SLAB)      return slab->get_slab_slack();
+        return 0;
+    }
+
+    int used_memory() const {
+        if (kind <= A_TLSF)      return linear->get_total_size() - linear->get_free_memory();
+        if (kind == A_SLAB)      return slab->get_used_memory();
+        return buddy->get_used_memory();
+    }
+};
+
+struct Measurement {
+    long long mallocs = 0, frees = 0, failed = 0;
+    double ops_per_sec = 0;
+    double malloc_p50 = 0, malloc_p99 = 0;
+    double free_p50 = 0, free_p99 = 0;
+    size_t peak_metadata = 0;
+    int internal_frag = 0, external_frag = 0;
+    double utilization = 0;
+};
+
+static double percentile(vector<uint32_t> &v, double p) {
+    if (v.empty()) return 0;
+    size_t k = min(v.size() - 1, (size_t)(p * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static Measurement measure(AllocKind kind, const vector<Op> &ops, int objects, const Config &cfg) {
+    Measurement m;
+    vector<int> addr(objects, -1);
+    vector<uint32_t> malloc_ns, free_ns;
+    malloc_ns.reserve(ops.size());
+    free_ns.reserve(ops.size());
+
+    // Throughput pass; also the one whose host memory is counted.
+    {
+        size_t base = live_bytes;
+        peak_bytes = live_bytes;
+
+        Subject s(kind, cfg.heap);
+        int next = 0;
+        auto start = chrono::steady_clock::now();
+        for (const Op &op : ops) {
+            if (op.is_free) {
+                if (addr[op.value] != -1)
+                    s.release(addr[op.value]);
+            }
+            else {
+                addr[next++] = s.allocate(op.value);
+            }
+        }
+        chrono::duration<double> secs = chrono::steady_clock::now() - start;
+
+        m.ops_per_sec = ops.size() / secs.count();
+        m.peak_metadata = peak_bytes - base;
+        m.internal_frag = s.internal_fragmentation();
+        m.external_frag = s.external_fragmentation();
+        m.utilization = s.used_memory() * 100.0 / cfg.heap;
+    }
+
+    // Latency pass on a fresh instance.
+    fill(addr.begin(), addr.end(), -1);
+    Subject s(kind, cfg.heap);
+    int next = 0;
+    for (const Op &op : ops) {
+        if (op.is_free) {
+            int a = addr[op.value];
+            if (a == -1)
+                continue;
+            auto t0 = chrono::steady_clock::now();
+            s.release(a);
+            auto t1 = chrono::steady_clock::now();
+            free_ns.push_back((uint32_t)chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
+            m.frees++;
+        }
+        else {
+            auto t0 = chrono::steady_clock::now();
+            int a = s.allocate(op.value);
+            auto t1 = chrono::steady_clock::now();
+            malloc_ns.push_back((uint32_t)chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
+            addr[next++] = a;
+            m.mallocs++;
+            if (a == -1) m.failed++;
+        }
+    }
+
+    m.malloc_p50 = percentile(malloc_ns, 0.50);
+    m.malloc_p99 = percentile(malloc_ns, 0.99);
+    m.free_p50 = percentile(free_ns, 0.50);
+    m.free_p99 = percentile(free_ns, 0.99);
+    return m;
+}
+
+// Median cost of the two clock reads around each timed call.
+static double timer_overhead_ns() {
+    vector<uint32_t> d(10001);
+    for (auto &x : d) {
+        auto t0 = chrono::steady_clock::now();
+        auto t1 = chrono::steady_clock::now();
+        x = (uint32_t)chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+    }
+    return percentile(d, 0.5);
+}
+
+static bool parse_args(int argc, char **argv, Config &cfg) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        string val = argv[++i];
+
+        if (arg == "--events")        cfg.events = atoll(val.c_str());
+        else if (arg == "--live")     cfg.live = atoi(val.c_str());
+        else if (arg == "--heap")     cfg.heap = atoi(val.c_str());
+        else if (arg == "--seed")     cfg.seed = (unsigned)atoll(val.c_str());
+        else if (arg == "--min-size") cfg.min_size = atoi(val.c_str());
+        else if (arg == "--max-size") cfg.max_size = atoi(val.c_str());
+        else if (arg == "--sizes") {
+            if (val == "uniform")       cfg.dists = { UNIFORM };
+            else if (val == "powerlaw") cfg.dists = { POWER_LAW };
+            else if (val == "bimodal")  cfg.dists = { BIMODAL };
+            else if (val != "all") {
+                cerr << "unknown size distribution: " << val << "\n";
+                return false;
+            }
+        }
+        else if (arg == "--order") {
+            if (val == "lifo")          cfg.orders = { LIFO };
+            else if (val == "fifo")     cfg.orders = { FIFO };
+            else if (val == "random")   cfg.orders = { RANDOM_ORDER };
+            else if (val != "all") {
+                cerr << "unknown free order: " << val << "\n";
+                return false;
+            }
+        }
+        else {
+            cerr << "unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (cfg.events < 1 || cfg.live < 1 || cfg.min_size < 1 || cfg.max_size < cfg.min_size) {
+        cerr << "events, live and sizes must be positive, with min-size <= max-size\n";
+        return false;
+    }
+    if (cfg.heap < 128 || (cfg.heap & (cfg.heap - 1))) {
+        cerr << "heap must be a power of two of at least 128 bytes\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Config cfg;
+    if (!parse_args(argc, argv, cfg))
+        return 1;
+
+    cout << fixed << setprecision(1);
+    cout << "{\n";
+    cout << "  \"benchmark\": \"alloc_bench\",\n";
+    cout << "  \"config\": {\"events\": " << cfg.events
+         << ", \"live\": " << cfg.live
+         << ", \"heap\": " << cfg.heap
+         << ", \"min_size\": " << cfg.min_size
+         << ", \"max_size\": " << cfg.max_size
+         << ", \"seed\": " << cfg.seed << "},\n";
+    cout << "  \"timer_overhead_ns\": " << timer_overhead_ns() << ",\n";
+    cout << "  \"results\": [";
+
+    bool first = true;
+    for (SizeDist dist : cfg.dists) {
+        for (FreeOrder order : cfg.orders) {
+            vector<Op> ops = generate(dist, order, cfg);
+            int objects = (int)count_if(ops.begin(), ops.end(), [](const Op &o) { return !o.is_free; });
+
+            for (int k = 0; k < ALLOC_COUNT; k++) {
+                Measurement m = measure((AllocKind)k, ops, objects, cfg);
+
+                cout << (first ? "\n" : ",\n");
+                first = false;
+                cout << "    {\"sizes\": \"" << dist_names[dist] << "\""
+                     << ", \"order\": \"" << order_names[order] << "\""
+                     << ", \"allocator\": \"" << alloc_names[k] << "\""
+                     << ", \"mallocs\": " << m.mallocs
+                     << ", \"frees\": " << m.frees
+                     << ", \"failed_allocs\": " << m.failed
+                     << ", \"ops_per_sec\": " << m.ops_per_sec
+                     << ", \"malloc_ns\": {\"p50\": " << m.malloc_p50 << ", \"p99\": " << m.malloc_p99 << "}"
+                     << ", \"free_ns\": {\"p50\": " << m.free_p50 << ", \"p99\": " << m.free_p99 << "}"
+                     << ", \"peak_metadata_bytes\": " << m.peak_metadata
+                     << ", \"internal_frag_bytes\": " << m.internal_frag
+                     << ", \"external_frag_bytes\": " << m.external_frag
+                     << ", \"utilization_pct\": " << m.utilization << "}";
+                cout.flush();
+            }
+        }
+    }
+    cout << "\n  ]\n}\n";
+    return 0;
+}
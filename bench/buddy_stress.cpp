@@ -0,0 +1,123 @@
+// Multi-threaded buddy allocator stress test.
+//
+// Every worker keeps a bounded live set and does random malloc/free
+// pairs. The same run is timed on the concurrent allocator (magazines
+// over per-order locked free lists) and on a plain BuddyAllocator behind
+// one mutex, for 1, 2, 4, ... threads.
+//
+// usage: buddy_stress [max_threads] [ops_per_thread]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+#include "../include/buddy.h"
+#include "../include/concurrent_buddy.h"
+
+using namespace std;
+
+static const int MEMORY_SIZE = 1 << 28;
+static const int MIN_BLOCK = 128;
+static const int LIVE_BLOCKS = 256;
+
+// Mostly small requests with an occasional large one.
+static int request_size(mt19937 &rng) {
+    int r = rng() % 100;
+    if (r < 90) return 16 + rng() % 1008;
+    return 1024 + rng() % 15360;
+}
+
+template <class Alloc, class Free>
+static void worker(int seed, long long ops, Alloc do_malloc, Free do_free) {
+    mt19937 rng(seed);
+    vector<int> live;
+    live.reserve(LIVE_BLOCKS);
+
+    for (long long i = 0; i < ops; i++) {
+        if ((int)live.size() == LIVE_BLOCKS || (!live.empty() && rng() % 2)) {
+            size_t k = rng() % live.size();
+            do_free(live[k]);
+            live[k] = live.back();
+            live.pop_back();
+        } else {
+            int addr = do_malloc(request_size(rng));
+            if (addr != -1)
+                live.push_back(addr);
+        }
+    }
+    for (int addr : live)
+        do_free(addr);
+}
+
+static double run_locked(int threads, long long ops) {
+    BuddyAllocator buddy(MEMORY_SIZE, MIN_BLOCK);
+    mutex lock;
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            worker(t + 1, ops,
+                [&](int size) { lock_guard<mutex> g(lock); return buddy.buddy_malloc(size); },
+                [&](int addr) { lock_guard<mutex> g(lock); buddy.buddy_free(addr); });
+        });
+    }
+    for (auto &th : pool) th.join();
+    chrono::duration<double> secs = chrono::steady_clock::now() - start;
+    return threads * ops / secs.count();
+}
+
+static double run_concurrent(int threads, long long ops, long long &locks) {
+    ConcurrentBuddyAllocator buddy(MEMORY_SIZE, MIN_BLOCK);
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            ConcurrentBuddyAllocator::ThreadCache cache(buddy);
+            worker(t + 1, ops,
+                [&](int size) { return buddy.buddy_malloc(cache, size); },
+                [&](int addr) { buddy.buddy_free(cache, addr); });
+        });
+    }
+    for (auto &th : pool) th.join();
+    chrono::duration<double> secs = chrono::steady_clock::now() - start;
+
+    locks = buddy.get_list_locks();
+    buddy.drain();
+    if (buddy.get_used_memory() != 0)
+        cerr << "warning: " << buddy.get_used_memory() << " bytes still in use\n";
+    return threads * ops / secs.count();
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+    long long ops = argc > 2 ? atoll(argv[2]) : 1000000;
+    if (max_threads < 1) max_threads = 1;
+
+    cout << left
+         << setw(10) << "Threads"
+         << setw(18) << "Locked ops/s"
+         << setw(18) << "Magazine ops/s"
+         << setw(10) << "Speedup"
+         << "ListLocks\n";
+
+    cout << fixed << setprecision(0);
+    for (int t = 1; t <= max_threads; t *= 2) {
+        long long locks = 0;
+        double locked = run_locked(t, ops);
+        double conc = run_concurrent(t, ops, locks);
+
+        cout << setw(10) << t
+             << setw(18) << locked
+             << setw(18) << conc
+             << setw(10) << setprecision(2) << conc / locked << setprecision(0)
+             << locks << "\n";
+    }
+    return 0;
+}
@@ -3,7 +3,8 @@
 
 #include <vector>
 #include <unordered_map>
-#include <list>
+#include <cstdint>
+#include "handles.h"
 using namespace std;
 
 class BuddyAllocator {
@@ -13,16 +14,29 @@ private:
     int max_order;
     int used_memory = 0;
 
-    vector<list<int>> free_list;
+    // Per-order free lists, doubly linked through arrays indexed by
+    // (addr >> min_order), plus one bit per block of each order marking
+    // it free. Buddy checks and removals are O(1).
+    vector<int> free_head;
+    vector<int> free_tail;
+    vector<int> link_prev;
+    vector<int> link_next;
+    vector<vector<uint64_t>> free_bits;
     unordered_map<int,int> allocated_order;
     unordered_map<int,int> requested_size;  
+    HandleTable *handles;
 
 
     int size_to_order(int size);
     bool is_power_of_two(int x);
 
+    bool is_free(int order, int addr) const;
+    void push_free(int order, int addr);
+    int pop_free(int order);
+    void remove_free(int order, int addr);
+
 public:
-    BuddyAllocator(int memory_size, int min_block_size);
+    BuddyAllocator(int memory_size, int min_block_size, HandleTable *handles = nullptr);
 
     int buddy_malloc(int size);
     void buddy_free(int addr);
@@ -2,37 +2,104 @@
 #define CACHE_H
 
 #include <vector>
-#include <queue>
 #include <string>
-struct CacheLine {
-    bool valid;
-    int tag;
-};
-extern int l1_penalty;
-extern int l2_penalty;
-extern int memory_penalty;
+#include <memory>
+#include "replacement.h"
+#include "prefetch.h"
+
+extern long long total_cycles;
 
-extern int total_cycles;
+// Address to block, and block to set and tag, for `num_sets` sets of
+// `block_size`-byte blocks. The stack-distance profiler splits its
+// per-set streams with the same mapping.
+struct BlockMapping {
+    int block_size;
+    int num_sets;
+
+    int block(int address) const { return address / block_size; }
+    int set(int block) const { return block % num_sets; }
+    int tag(int block) const { return block / num_sets; }
+    int address(int set, int tag) const { return (tag * num_sets + set) * block_size; }
+};
 
 class Cache {
 private:
     int cache_size;    
-    int block_size;    
+    BlockMapping mapping;
     int associativity; 
-    int num_sets;     
+    int stride;        // ways per set rounded up to the SIMD width
+
+    // Tags of all sets in one array, set s at [s * stride, s * stride + associativity).
+    // INVALID_TAG marks an empty way and fills the padding.
+    std::vector<int> tags;
+    ReplacementState repl;
 
-    std::vector<std::vector<CacheLine>> sets;
-    std::vector<std::queue<int>> fifo;
+    static constexpr int INVALID_TAG = -1;
 
-    int accesses = 0;
-    int hits = 0;
-    int misses = 0;
+    int find_way(int set_index, int tag) const;
+    int fill(int address, bool by_prefetch, long long ready);
+
+    long long accesses = 0;
+    long long hits = 0;
+    long long misses = 0;
+
+    // Prefetch state, sized only while a prefetcher is attached. Per way:
+    // filled by a prefetch and not yet used, and the cycle the fill
+    // completes. `polluters` is a direct-mapped filter of demand blocks
+    // evicted by prefetch fills; a later miss on one of them counts the
+    // prefetch as polluting.
+    std::unique_ptr<Prefetcher> prefetcher;
+    std::vector<char> prefetched;
+    std::vector<long long> ready_at;
+    std::vector<int> polluters;
+    std::vector<int> proposed;
+
+    long long pf_issued = 0;
+    long long pf_useful = 0;
+    long long pf_late = 0;
+    long long pf_late_cycles = 0;
+    long long pf_unused = 0;        // evicted before any demand use
+    long long pf_polluting = 0;
 
 public:
-    Cache(int C, int b, int N);
+    Cache(int C, int b, int N, ReplacementKind policy = REPL_FIFO);
 
     bool access(int address);   
-    void insert(int address);
+
+    // Hit check with stats and replacement update, but no fill on a miss.
+    bool lookup(int address);
+
+    // Fills the block; returns the address of the block it evicted, or -1.
+    int insert(int address);
+
+    // Drops the block if present (coherence invalidation).
+    bool invalidate(int address);
+
+    // Present without touching stats or replacement state.
+    bool contains(int address) const;
+
+    int get_size() const { return cache_size; }
+    int get_block_size() const { return mapping.block_size; }
+    int get_num_sets() const { return mapping.num_sets; }
+    int get_associativity() const { return associativity; }
+    ReplacementKind get_policy() const { return repl.get_kind(); }
+
+    long long get_accesses() const { return accesses; }
+    long long get_hits() const { return hits; }
+    long long get_misses() const { return misses; }
+
+    // Attaches a prefetcher (PF_NONE detaches) and clears its stats.
+    void set_prefetcher(PrefetchKind kind, int page_size, int degree, int distance);
+    bool has_prefetcher() const { return prefetcher != nullptr; }
+
+    // Block addresses the prefetcher proposed since the caller last
+    // cleared the vector; the caller fetches them and calls prefetch_fill.
+    std::vector<int> &prefetch_queue() { return proposed; }
+
+    // Fills a prefetched block whose data arrives at cycle `ready`. A
+    // demand hit before then stalls for the rest (a late prefetch).
+    // Returns the evicted block's address, or -1.
+    int prefetch_fill(int address, long long ready);
 
     void print_stats(const std::string &name) const;
 };
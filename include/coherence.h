@@ -0,0 +1,91 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include "cache.h"
+#include "hierarchy.h"
+
+using namespace std;
+
+// N private L1 caches in front of the shared levels (L2 down) of a cache
+// hierarchy, kept coherent with MESI by a directory at the L2. For every block the directory records which
+// cores hold a copy (sharers) and whether one core holds it exclusively
+// (owner, E or M; dirty = M):
+//   read miss  - E if nobody else has it, else S; an E/M owner drops to S
+//                and an M owner supplies the data cache-to-cache
+//   write      - every other copy is invalidated and the writer is M; a
+//                write hit on S is an upgrade (directory round trip)
+//   eviction   - the core leaves the sharers; an M copy is written back
+// A miss on a block this core lost to an invalidation is a coherence
+// miss. It is true sharing if another core wrote the word now accessed
+// since the copy was lost, false sharing otherwise. The private L1s take
+// the hierarchy's L1 geometry and latency; an inclusive hierarchy
+// back-invalidates them when a shared level evicts a block.
+class CoherentCaches {
+public:
+    static const int MAX_CORES = 64;
+
+private:
+    struct DirEntry {
+        uint64_t sharers = 0;
+        int owner = -1;         // core holding the block in E or M
+        bool dirty = false;     // owner's copy is M
+        uint64_t lost = 0;      // cores whose copy was invalidated
+    };
+
+    struct CoreStats {
+        long long accesses = 0;
+        long long hits = 0;
+        long long misses = 0;
+        long long coherence_misses = 0;
+        long long upgrades = 0;
+        long long invalidated = 0;      // copies this core lost
+        long long writebacks = 0;
+        long long cycles = 0;
+    };
+
+    int cores;
+    int block_size;
+    int word_bytes;             // false-sharing granularity, 64 words per block at most
+    vector<unique_ptr<Cache>> l1;
+    CacheHierarchy &shared;
+
+    unordered_map<int, DirEntry> directory;             // block number -> entry
+    unordered_map<long long, uint64_t> remote_words;    // (block, lost core) -> words written since
+    unordered_map<int, long long> false_sharing_lines;  // block number -> false-sharing misses
+    map<pair<int, int>, int> core_of_stream;            // (pid, thread) -> core
+
+    vector<CoreStats> stats;
+    long long invalidations = 0;
+    long long transfers = 0;        // misses served by another core's M copy
+    long long back_invalidations = 0;   // L1 copies dropped for inclusion
+    long long true_sharing = 0;
+    long long false_sharing = 0;
+
+    static long long lost_key(int block, int core) { return (long long)block * MAX_CORES + core; }
+
+    void invalidate_others(DirEntry &d, int block, int core);
+    void record_write(DirEntry &d, int block, int core, int word);
+    void classify_coherence_miss(DirEntry &d, int block, int core, int word);
+    void drop(int block, int core);
+    void drop_back_invalidated();
+
+public:
+    CoherentCaches(int cores, CacheHierarchy &shared);
+
+    int get_cores() const { return cores; }
+
+    // Streams are given cores round robin in the order they first appear.
+    int core_of(int pid, int thread);
+
+    // One access by `core`; returns its cycles (also added to the core).
+    long long access(int core, int addr, bool write);
+
+    void print_stats() const;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef CONCURRENT_BUDDY_H
+#define CONCURRENT_BUDDY_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+using namespace std;
+
+// Buddy allocator that can be shared by many threads.
+//
+// Each order has its own free list and free bitmap behind its own lock,
+// so threads working on different orders never contend. A malloc takes
+// the order locks one at a time going up until it finds a block, then
+// pushes the split-off halves down one order lock at a time. A free
+// checks and removes its buddy under that order's lock, so a block and
+// its buddy can never both sit free in a list, and then moves up to the
+// next order. At most one lock is held at any time, always climbing, so
+// there is no lock ordering to get wrong.
+//
+// Blocks of the CACHED_ORDERS smallest orders also go through per-thread
+// magazines: a thread allocates and frees from its own magazine without
+// locking, and only touches shared state to swap a whole magazine with
+// the per-order depot, or to refill or flush a batch of MAGAZINE_SIZE
+// blocks through the free lists.
+class ConcurrentBuddyAllocator {
+public:
+    static const int MAGAZINE_SIZE = 32;
+    static const int CACHED_ORDERS = 4;
+    static const int DEPOT_LIMIT = 4;      // full magazines kept per order
+
+    // Per-thread state. Create one per worker thread; it hands its blocks
+    // back when destroyed.
+    class ThreadCache {
+        friend class ConcurrentBuddyAllocator;
+        ConcurrentBuddyAllocator &owner;
+        vector<int> loaded[CACHED_ORDERS];
+    public:
+        explicit ThreadCache(ConcurrentBuddyAllocator &a);
+        ~ThreadCache();
+    };
+
+private:
+    struct Depot {
+        mutex lock;
+        vector<vector<int>> full;
+    };
+
+    // One cache line per order, so the locks of neighbouring orders do
+    // not share a line.
+    struct alignas(64) OrderList {
+        mutex lock;
+        int head = -1;
+        vector<uint64_t> bits;      // one bit per block of the order, set if free
+        long long locks = 0;        // times the lock was taken
+    };
+
+    int min_order;
+    int max_order;
+    int num_blocks;
+
+    unique_ptr<OrderList[]> lists;          // lists[order]
+    vector<int> link_prev;                  // per min block, links of a free block
+    vector<int> link_next;
+    unique_ptr<atomic<int8_t>[]> block_order;   // per min block, -1 if not handed out
+    atomic<int> used_memory{0};
+
+    Depot depots[CACHED_ORDERS];
+
+    int size_to_order(int size) const;
+
+    // Callers hold lists[order].lock.
+    bool is_free(int order, int addr) const;
+    void push_free(int order, int addr);
+    void remove_free(int order, int addr);
+
+    int take_block(int order);
+    void give_block(int order, int addr);
+
+    void refill(ThreadCache &tc, int slot);
+    void flush(ThreadCache &tc, int slot);
+    void release_blocks(vector<int> &blocks, int order);
+
+public:
+    ConcurrentBuddyAllocator(int memory_size, int min_block_size);
+
+    int buddy_malloc(ThreadCache &tc, int size);
+    void buddy_free(ThreadCache &tc, int addr);
+
+    // Returns every depot magazine to the free lists.
+    void drain();
+
+    // Bytes taken from the free lists, including blocks parked in
+    // magazines and depots.
+    int get_used_memory() const;
+
+    // Number of times an order's free-list lock was taken.
+    long long get_list_locks();
+};
+
+#endif
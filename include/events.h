@@ -0,0 +1,70 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <cstdint>
+#include <string>
+#include <iostream>
+
+// Per-access simulation events (page table and cache lookups) go through
+// one sink instead of straight to cout. The verbosity level decides what
+// happens to them:
+//   off      - nothing
+//   counters - tallied per event type, shown by 'stats'
+//   text     - tallied and printed as text lines (interactive default)
+//   trace    - tallied and appended to a buffered binary log; decode it
+//              with 'trace_tool events <file>'
+enum SimEvent {
+    EV_PAGE_HIT,
+    EV_PAGE_FAULT,
+    EV_PAGE_EVICTION,
+    EV_PAGE_MAPPED,
+    EV_INVALID_VADDR,
+    EV_L1_HIT,
+    EV_L2_HIT,
+    EV_MEMORY_ACCESS,
+    EV_NO_FRAME,        // page fault with every frame pinned
+    EV_L1_TRANSFER,     // multi-core: L1 miss served by another core's L1
+    EV_L1_INVALIDATE,   // multi-core: a core's copy invalidated by a write
+    EV_CACHE_HIT,       // hit below L2; b is the level (3 = L3)
+    EV_COUNT
+};
+
+enum Verbosity { VERBOSITY_OFF, VERBOSITY_COUNTERS, VERBOSITY_TEXT, VERBOSITY_TRACE };
+
+// Binary log: "MSEVENT1" then one record per event.
+struct EventRecord {
+    uint16_t type;
+    uint16_t reserved;
+    int32_t pid;
+    int64_t a;      // page, or physical address for cache events
+    int64_t b;      // frame, core for coherence events, or cache level
+};
+
+static_assert(sizeof(EventRecord) == 24, "event record must be 24 bytes");
+
+extern const char EVENT_MAGIC[8];
+
+extern Verbosity verbosity;
+extern long long event_counts[EV_COUNT];
+
+void log_event(SimEvent ev, int pid, long long a, long long b);
+
+inline void emit_event(SimEvent ev, int pid, long long a, long long b) {
+    if (verbosity == VERBOSITY_OFF)
+        return;
+    event_counts[ev]++;
+    if (verbosity != VERBOSITY_COUNTERS)
+        log_event(ev, pid, a, b);
+}
+
+// Switches level; 'trace' needs the log file path. False on failure.
+bool set_verbosity(const std::string &level, const std::string &path);
+const char *verbosity_name();
+
+void reset_event_counts();
+void print_event_counts();
+
+// The text line for an event, as printed in 'text' mode.
+void format_event(std::ostream &out, const EventRecord &r);
+
+#endif
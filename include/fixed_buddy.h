@@ -0,0 +1,149 @@
+#ifndef FIXED_BUDDY_H
+#define FIXED_BUDDY_H
+
+#include <array>
+#include <cstdint>
+
+// Buddy allocator with the minimum block and total size fixed at compile
+// time. Orders, list heads and bitmap layout are constants, and request
+// orders come from __builtin_clz instead of a shift loop. It follows the
+// same free-list discipline as BuddyAllocator, so both give identical
+// results on the same workload. Objects are large; allocate them on the
+// heap.
+template <int MinBlock, int TotalSize>
+class FixedBuddyAllocator {
+    static_assert(MinBlock > 0 && (MinBlock & (MinBlock - 1)) == 0, "MinBlock must be a power of two");
+    static_assert(TotalSize >= MinBlock && (TotalSize & (TotalSize - 1)) == 0, "TotalSize must be a power of two >= MinBlock");
+
+    static constexpr int log2(int x) { return x > 1 ? 1 + log2(x >> 1) : 0; }
+
+public:
+    static constexpr int MIN_ORDER = log2(MinBlock);
+    static constexpr int MAX_ORDER = log2(TotalSize);
+    static constexpr int BLOCKS = TotalSize / MinBlock;
+
+private:
+    static constexpr int ORDERS = MAX_ORDER + 1;
+
+    // Bit offset of each order's bitmap inside free_bits.
+    static constexpr int bit_offset(int order) {
+        return order <= MIN_ORDER ? 0 : bit_offset(order - 1) + (TotalSize >> (order - 1));
+    }
+    static constexpr int BIT_WORDS = (bit_offset(MAX_ORDER) + 1 + 63) / 64;
+
+    std::array<int, ORDERS> free_head;
+    std::array<int, ORDERS> free_tail;
+    std::array<int, BLOCKS> link_prev;
+    std::array<int, BLOCKS> link_next;
+    std::array<int8_t, BLOCKS> alloc_order;     // -1 unless a block starts here
+    std::array<uint64_t, BIT_WORDS> free_bits;
+    int used_memory = 0;
+
+    static int size_to_order(int size) {
+        int order = size > 1 ? 32 - __builtin_clz((unsigned)(size - 1)) : 0;
+        return order < MIN_ORDER ? MIN_ORDER : order;
+    }
+
+    bool is_free(int order, int addr) const {
+        int b = bit_offset(order) + (addr >> order);
+        return (free_bits[b >> 6] >> (b & 63)) & 1;
+    }
+
+    void flip_bit(int order, int addr) {
+        int b = bit_offset(order) + (addr >> order);
+        free_bits[b >> 6] ^= (uint64_t)1 << (b & 63);
+    }
+
+    void push_free(int order, int addr) {
+        int i = addr >> MIN_ORDER;
+        link_prev[i] = free_tail[order];
+        link_next[i] = -1;
+
+        if (free_tail[order] != -1)
+            link_next[free_tail[order] >> MIN_ORDER] = addr;
+        else
+            free_head[order] = addr;
+        free_tail[order] = addr;
+
+        flip_bit(order, addr);
+    }
+
+    void remove_free(int order, int addr) {
+        int i = addr >> MIN_ORDER;
+        int p = link_prev[i];
+        int n = link_next[i];
+
+        if (p != -1) link_next[p >> MIN_ORDER] = n;
+        else         free_head[order] = n;
+        if (n != -1) link_prev[n >> MIN_ORDER] = p;
+        else         free_tail[order] = p;
+
+        flip_bit(order, addr);
+    }
+
+public:
+    FixedBuddyAllocator() {
+        free_head.fill(-1);
+        free_tail.fill(-1);
+        alloc_order.fill(-1);
+        free_bits.fill(0);
+        push_free(MAX_ORDER, 0);
+    }
+
+    int buddy_malloc(int size) {
+        int req_order = size_to_order(size);
+
+        int cur_order = req_order;
+        while (cur_order <= MAX_ORDER && free_head[cur_order] == -1)
+            cur_order++;
+
+        if (cur_order > MAX_ORDER)
+            return -1;
+
+        int addr = free_head[cur_order];
+        remove_free(cur_order, addr);
+
+        while (cur_order > req_order) {
+            cur_order--;
+            push_free(cur_order, addr + (1 << cur_order));
+        }
+
+        alloc_order[addr >> MIN_ORDER] = (int8_t)req_order;
+        used_memory += (1 << req_order);
+        return addr;
+    }
+
+    void buddy_free(int addr) {
+        if (addr < 0 || addr >= TotalSize || (addr & (MinBlock - 1)))
+            return;
+
+        int order = alloc_order[addr >> MIN_ORDER];
+        if (order < 0)
+            return;
+
+        alloc_order[addr >> MIN_ORDER] = -1;
+        used_memory -= (1 << order);
+
+        while (order < MAX_ORDER) {
+            int buddy = addr ^ (1 << order);
+            if (!is_free(order, buddy))
+                break;
+
+            remove_free(order, buddy);
+            addr = addr < buddy ? addr : buddy;
+            order++;
+        }
+
+        push_free(order, addr);
+    }
+
+    int get_order(int addr) const {
+        if (addr < 0 || addr >= TotalSize || (addr & (MinBlock - 1)))
+            return -1;
+        return alloc_order[addr >> MIN_ORDER];
+    }
+
+    int get_used_memory() const { return used_memory; }
+};
+
+#endif
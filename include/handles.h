@@ -0,0 +1,43 @@
+#ifndef HANDLES_H
+#define HANDLES_H
+
+#include <vector>
+#include <unordered_map>
+using namespace std;
+
+// Block ids shared by the linear and buddy allocators.
+// Ids are issued in order and never reissued, so freeing an id twice is
+// reported as such. A released slot is reused by a later block, and each
+// slot records the id it was last issued under, so the table only grows
+// with the number of live blocks.
+class HandleTable {
+public:
+    enum Owner { LINEAR, BUDDY };
+    enum Status { LIVE, STALE, UNKNOWN };
+
+private:
+    struct Entry {
+        int addr;
+        Owner owner;
+        int id;
+    };
+
+    vector<Entry> entries;              // entries[slot]
+    vector<int> spare;                  // released slots
+    unordered_map<int,int> slot_of;     // live id -> slot
+    unordered_map<int,int> slot_at;     // address -> slot
+    int next_id = 1;
+
+public:
+    int issue(int addr, Owner owner);
+    void release(int addr);
+
+    int id_of(int addr) const;
+    Status find(int id, int &addr, Owner &owner) const;
+
+    void clear();
+};
+
+extern HandleTable block_handles;
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <vector>
+using namespace std;
+
+// One block of the simulated heap. Blocks live in a flat vector of slots
+// and are chained in address order through prev/next slot indices, so
+// splitting and coalescing only touch the block and its neighbours.
+struct Block {
+    int start;
+    int size;
+    bool free;
+    int id;
+    int prev;   // slot of the block just below, -1 for the first block
+    int next;   // slot of the block just above, -1 for the last block
+    int free_prev;  // free-list links, used while the block is free
+    int free_next;
+};
+
+class BlockHeap {
+private:
+    vector<Block> slots;
+    vector<int> spare;      // released slots, reused before growing
+    int head = -1;
+
+    int new_slot(const Block &b);
+
+public:
+    template <class Heap, class B>
+    class basic_iterator {
+        Heap *heap;
+        int slot;
+    public:
+        basic_iterator(Heap *h, int s) : heap(h), slot(s) {}
+        B &operator*() const { return heap->slots[slot]; }
+        B *operator->() const { return &heap->slots[slot]; }
+        basic_iterator &operator++() { slot = heap->slots[slot].next; return *this; }
+        bool operator!=(const basic_iterator &o) const { return slot != o.slot; }
+        bool operator==(const basic_iterator &o) const { return slot == o.slot; }
+    };
+    typedef basic_iterator<BlockHeap, Block> iterator;
+    typedef basic_iterator<const BlockHeap, const Block> const_iterator;
+
+    void reset(int total_size);
+
+    Block &operator[](int slot) { return slots[slot]; }
+    const Block &operator[](int slot) const { return slots[slot]; }
+
+    int first() const { return head; }
+
+    // Shrinks `slot` to `size` bytes and returns the slot of the new free
+    // block holding the remainder.
+    int split(int slot, int size);
+
+    // Absorbs the block after `slot` into it and releases its slot.
+    void merge_next(int slot);
+
+    iterator begin() { return iterator(this, head); }
+    iterator end() { return iterator(this, -1); }
+    const_iterator begin() const { return const_iterator(this, head); }
+    const_iterator end() const { return const_iterator(this, -1); }
+};
+
+#endif
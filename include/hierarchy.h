@@ -0,0 +1,90 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "cache.h"
+#include "stack_distance.h"
+
+enum InclusionPolicy { INCLUSION_NINE, INCLUSION_INCLUSIVE, INCLUSION_EXCLUSIVE };
+
+bool parse_inclusion(const std::string &name, InclusionPolicy &policy);
+const char *inclusion_name(InclusionPolicy policy);
+
+// Levels of cache in front of memory, level 0 closest to the core. An
+// access probes the levels in order, paying each one's latency, until one
+// hits (or memory is reached), then fills the levels that missed:
+//   NINE      - every missing level gets the block; an eviction in one
+//               level leaves the others alone (non-inclusive non-exclusive)
+//   INCLUSIVE - as NINE, but a block evicted from a level is also
+//               invalidated in every level above it (back-invalidation)
+//   EXCLUSIVE - a block lives in one level only: it moves to the top level
+//               on a hit below, and a victim spills to the next level down
+//               (needs the same block size in every level)
+// Inclusion also needs each level's block to cover the one above it.
+// Levels above `from` in access() belong to the caller (private L1s in
+// multi-core mode); blocks that inclusion removes from them are queued in
+// back_invalidated() for the caller to drop.
+class CacheHierarchy {
+private:
+    struct Level {
+        std::unique_ptr<Cache> cache;
+        int latency;
+        std::unique_ptr<StackProfiler> profiler;    // demand stream reaching the level
+    };
+
+    std::vector<Level> levels;
+    int memory_size;        // prefetches at or past it are not fetched
+    int memory_latency;
+    InclusionPolicy inclusion = INCLUSION_NINE;
+
+    long long back_invalidations = 0;
+    long long prefetch_cycles = 0;      // overlapped with demand work
+    std::vector<std::pair<int, int>> removed_above;     // (address, bytes)
+
+    void fill(int addr, int top, int from, int served, long long ready);
+    void place(int addr, int level, int from, long long ready);
+    void back_invalidate(int addr, int bytes, int level, int from);
+    bool held_above(int addr, int level, int from) const;
+    void issue_prefetches(int level, int from);
+
+public:
+    CacheHierarchy(int memory_size, int memory_latency);
+
+    // Appends a level below the current last one.
+    void add_level(int size, int block, int ways, ReplacementKind policy, int latency);
+
+    int get_levels() const { return (int)levels.size(); }
+    Cache &level(int i) { return *levels[i].cache; }
+    int get_latency(int i) const { return levels[i].latency; }
+    int get_memory_latency() const { return memory_latency; }
+
+    // Level get_levels() is memory.
+    void set_latency(int level, int cycles);
+
+    InclusionPolicy get_inclusion() const { return inclusion; }
+    void set_inclusion(InclusionPolicy policy);
+
+    // Whether the block sizes suit the policy: exclusive needs one block
+    // size, inclusive blocks that never shrink going down. `next_block` is
+    // the block size of a level about to be added, 0 for none.
+    bool fits_inclusion(InclusionPolicy policy, int next_block = 0) const;
+
+    // Demand access entering at level `from`; emits the cache event and
+    // returns the cycles. Prefetchers of the levels used are served after.
+    long long access(int addr, int from = 0);
+
+    std::vector<std::pair<int, int>> &back_invalidated() { return removed_above; }
+
+    // Takes ownership; nullptr stops profiling the level.
+    void set_profiler(int level, StackProfiler *profiler);
+
+    bool has_prefetcher() const;
+    long long get_prefetch_cycles() const { return prefetch_cycles; }
+
+    // Levels from `from` down, named L1, L2, ..., then their profiles.
+    void print_stats(int from = 0) const;
+};
+
+#endif
@@ -1,58 +1,73 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-#include <list>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <unordered_map>
+#include <set>
+#include <map>
+#include "heap.h"
+#include "handles.h"
+#include "tlsf.h"
 
 
 using namespace std;
-extern int total_memory_size;
 
-
-extern int next_block_id;
-extern unordered_map<int,int> buddy_ids;  
-
-
-
-struct Block {
-    int start;
-    int size;
-    bool free;
-    int id;   
+// First/best/worst fit and TLSF over one simulated heap. All state lives
+// in the instance, so compare can replay the workload on private copies
+// while the interactive heap keeps its blocks. Block ids are only issued
+// when a HandleTable is given.
+class LinearAllocator {
+private:
+    int total_size = 0;
+    BlockHeap blocks;
+    HandleTable *handles;
+
+    // Free-block indexes kept alongside the heap so no strategy walks
+    // the whole heap. The TLSF index is always maintained; the sorted
+    // indexes used by FF/BF/WF are only built once one of them is called,
+    // so a TLSF-only run keeps O(1) malloc and free.
+    TlsfIndex tlsf;
+    bool fit_index_live = false;
+    set<pair<int,int>> free_by_size;        // (size, start)
+    map<int,int> free_by_addr;              // start -> slot of free block
+    unordered_map<int,int> used_by_addr;    // start -> slot of used block
+
+    int total_alloc_requests = 0;
+    int successful_allocs = 0;
+    int failed_allocs = 0;
+
+    void index_free(int slot);
+    void unindex_free(int slot);
+    void build_fit_index();
+    int place_block(int slot, int size);
+    bool check_request(int size);
+
+public:
+    LinearAllocator(int memory_size, HandleTable *handles = nullptr);
+
+    void reset(int memory_size);
+    void reset_allocation_stats();
+
+    int malloc_first_fit(int size);
+    int malloc_best_fit(int size);
+    int malloc_worst_fit(int size);
+    int malloc_tlsf(int size);
+    void free_block(int start_address);
+
+    void dump_memory() const;
+
+    int get_total_size() const { return total_size; }
+    int get_free_memory() const;
+    int internal_fragmentation() const;
+    int external_fragmentation() const;
+    double memory_utilization() const;
+    double success_rate() const;
+
+    void allocation_stats() const;
 };
 
-int get_block_id(int start_address);
-int get_block_start_by_id(int id);
-
-
-extern list<Block> memory_blocks;
-
-
-void init_memory(int total_size);
-void dump_memory();
-
-
-int malloc_first_fit(int size);
-int malloc_best_fit(int size);
-int malloc_worst_fit(int size);
-void free_block(int start_address);
-
-
-int internal_fragmentation();
-int external_fragmentation();
-double memory_utilization();
-
-
-extern int total_alloc_requests;
-extern int successful_allocs;
-extern int failed_allocs;
-
-void allocation_stats();
-void reset_allocation_stats();
-
 enum EventType {
     ALLOC_EVENT,
     FREE_EVENT
@@ -60,12 +75,14 @@ enum EventType {
 
 struct Event {
     EventType type;
-    int value; 
+    int value;
 };
 
 extern vector<Event> workload;
 
 
-void compare_strategies();
+// Replays `events` on every strategy for each heap size, in parallel,
+// and prints one table per size.
+void compare_strategies(const vector<Event> &events, const vector<int> &heap_sizes);
 
-#endif
\ No newline at end of file
+#endif
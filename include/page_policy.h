@@ -0,0 +1,112 @@
+#ifndef PAGE_POLICY_H
+#define PAGE_POLICY_H
+
+#include <vector>
+#include <string>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <climits>
+#include <cstdint>
+
+enum PagePolicyKind {
+    PAGE_LRU,
+    PAGE_FIFO,
+    PAGE_CLOCK,
+    PAGE_SECOND_CHANCE,
+    PAGE_ARC,
+    PAGE_WORKING_SET,
+    PAGE_OPT
+};
+
+bool parse_page_policy(const std::string &name, PagePolicyKind &kind);
+const char *page_policy_name(PagePolicyKind kind);
+
+// Next-use index of a reference that is never repeated (OPT).
+const long long NEVER_USED = LLONG_MAX;
+
+struct PageKey {
+    int pid;
+    long long page;
+    bool operator==(const PageKey &o) const { return pid == o.pid && page == o.page; }
+};
+
+struct PageKeyHash {
+    size_t operator()(const PageKey &k) const {
+        return std::hash<long long>()(k.page * 0x9E3779B97F4A7C15ULL ^ (uint32_t)k.pid);
+    }
+};
+
+// Replacement state over physical frames. Every mapping is represented
+// by its first frame (the head); the VM reports maps, hits and unmaps and
+// asks for a victim among the heads it may evict:
+//   LRU           - recency list, victim from the tail
+//   FIFO          - load-order list, hits ignored
+//   CLOCK         - referenced bit per frame, a hand sweeps frame order
+//   SECOND_CHANCE - load-order list; a referenced tail page is cleared
+//                   and moved to the front instead of being evicted
+//   ARC           - adaptive split between recency (T1) and frequency (T2)
+//                   lists steered by ghost lists B1/B2 of evicted pages
+//   WORKING_SET   - evicts the least recent page that has not been used
+//                   in its process's last `window` references, else LRU
+//   OPT           - Belady: evicts the page whose next use is furthest
+//                   away, using next-use indices supplied per access
+class PagePolicy {
+private:
+    PagePolicyKind kind;
+    int num_frames;
+    int window;
+
+    struct FrameList {
+        int head = -1;      // most recent / newest
+        int tail = -1;
+        int size = 0;
+    };
+
+    // Per-frame state; lists are intrusive through prev/next.
+    std::vector<int> prev, next;
+    std::vector<uint8_t> on_list;       // 0 = unmapped, else list index
+    std::vector<uint8_t> referenced;
+    std::vector<PageKey> key;
+    std::vector<long long> stamp;       // WS: process time of last use; OPT: next use
+    FrameList lists[3];
+    int hand = 0;
+
+    // ARC
+    int target_t1 = 0;                  // p in the ARC paper
+    int ghost_hit = 0;                  // 1 or 2 if the faulting page was in B1/B2
+    std::list<PageKey> ghosts[3];       // [1] = B1, [2] = B2, front = most recent
+    std::unordered_map<PageKey, std::pair<int, std::list<PageKey>::iterator>, PageKeyHash> ghost_of;
+
+    // Working set: references made by each process so far.
+    std::unordered_map<int, long long> proc_time;
+
+    // OPT: mapped heads ordered by next use.
+    std::set<std::pair<long long, int>> by_next_use;
+
+    void push_front(int l, int f);
+    void unlink(int f);
+    int last_usable(int l, const std::function<bool(int)> &usable) const;
+
+    void forget_ghost(const PageKey &k);
+    void trim_ghosts();
+
+public:
+    PagePolicy(PagePolicyKind kind, int num_frames, int window = 0);
+
+    PagePolicyKind get_kind() const { return kind; }
+    int get_window() const { return window; }
+
+    // A fault on (pid, page) is about to be served; ARC adapts here.
+    void on_fault(int pid, long long page);
+    void on_map(int head, int pid, long long page, long long next_use = NEVER_USED);
+    void on_hit(int head, long long next_use = NEVER_USED);
+    // 'evicted' is false when the mapping is simply released (vm_init).
+    void on_unmap(int head, bool evicted);
+
+    // Head to evict among those `usable` accepts, or -1.
+    int victim(const std::function<bool(int)> &usable);
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <vector>
+#include <string>
+
+enum PrefetchKind { PF_NONE, PF_NEXT_LINE, PF_STRIDE, PF_STREAM };
+
+bool parse_prefetch(const std::string &name, PrefetchKind &kind);
+const char *prefetch_name(PrefetchKind kind);
+
+// Hardware prefetcher trained on the demand accesses of one cache. Each
+// access may propose block addresses to fetch; `distance` is how many
+// blocks ahead the first one is and `degree` how many are proposed.
+// Proposals never leave the page of the triggering access, as physical
+// neighbours across a page belong to unrelated mappings.
+//   NEXT_LINE - on a miss or a first hit on a prefetched block (tagged)
+//   STRIDE    - per-page stride table; after two repeats of the same
+//               stride, prefetches along it (traces carry no instruction
+//               pointer, so the page stands in for the IP)
+//   STREAM    - trackers watch misses in a window around their last
+//               block; once two moves agree on a direction the stream is
+//               confirmed and runs ahead of the demand accesses
+class Prefetcher {
+private:
+    PrefetchKind kind;
+    int block_size;
+    int page_size;
+    int degree;
+    int distance;
+
+    struct StrideEntry {
+        int page = -1;
+        int last_block = 0;
+        int stride = 0;
+        int confidence = 0;
+    };
+
+    struct Stream {
+        int last_block = -1;
+        int direction = 0;      // +1, -1, or 0 while training
+        bool confirmed = false;
+        unsigned long long used = 0;
+    };
+
+    static const int STRIDE_ENTRIES = 64;
+    static const int STREAMS = 16;
+    static const int STREAM_WINDOW = 16;    // blocks
+
+    std::vector<StrideEntry> strides;
+    std::vector<Stream> streams;
+    unsigned long long tick = 0;
+
+    void propose(int block, int step, int addr, std::vector<int> &out) const;
+
+public:
+    Prefetcher(PrefetchKind kind, int block_size, int page_size, int degree, int distance);
+
+    PrefetchKind get_kind() const { return kind; }
+    int get_degree() const { return degree; }
+    int get_distance() const { return distance; }
+
+    // Demand access; `trigger` is a miss or a first hit on a prefetched
+    // block. Appends block addresses to prefetch to `out`.
+    void on_access(int addr, bool trigger, std::vector<int> &out);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+enum ReplacementKind { REPL_FIFO, REPL_LRU, REPL_PLRU, REPL_SRRIP, REPL_BRRIP, REPL_RANDOM };
+
+bool parse_replacement(const std::string &name, ReplacementKind &kind);
+const char *replacement_name(ReplacementKind kind);
+
+// False if the policy cannot track a set of this many ways.
+bool replacement_supports(ReplacementKind kind, int ways);
+
+// Replacement state for a set-associative structure (cache sets, TLB
+// sets). Metadata for each set is a contiguous run of bytes in `meta`
+// (or one word in `plru_bits`, one int in `fifo_next`), so touching a
+// set touches one small region. LRU, PLRU and the RRIP policies keep
+// per-way state and take up to 64 ways; FIFO and RANDOM take any number:
+//   FIFO   - fifo_next[set] is the next way to evict (round robin)
+//   LRU    - per-way recency rank, 0 = most recent
+//   PLRU   - ways-1 tree bits per set, ways must be a power of two <= 64
+//   SRRIP  - per-way 2-bit re-reference prediction value
+//   BRRIP  - as SRRIP, but most fills are predicted distant
+//   RANDOM - no metadata, xorshift victim choice (fixed seed)
+class ReplacementState {
+private:
+    ReplacementKind kind;
+    int ways;
+    std::vector<uint8_t> meta;
+    std::vector<uint64_t> plru_bits;
+    std::vector<int> fifo_next;
+    uint32_t rng = 2463534242u;
+    uint32_t fills = 0;
+
+    static constexpr uint8_t RRPV_MAX = 3;
+
+    uint8_t *set_meta(int set) { return meta.data() + (size_t)set * ways; }
+
+public:
+    ReplacementState(ReplacementKind kind, int num_sets, int ways);
+
+    ReplacementKind get_kind() const { return kind; }
+
+    void on_hit(int set, int way);
+    void on_fill(int set, int way);
+
+    // Way to evict from a full set.
+    int victim(int set);
+};
+
+#endif
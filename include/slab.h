@@ -0,0 +1,67 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <vector>
+#include <unordered_map>
+#include "buddy.h"
+using namespace std;
+
+// Object caches for small fixed-size requests, built on pages taken from
+// a BuddyAllocator. Each size class keeps a list of slabs with free
+// objects; every slab threads its free objects through an embedded
+// freelist, so alloc and free are O(1). Requests larger than the biggest
+// class go straight to the buddy allocator.
+class SlabAllocator {
+private:
+    struct Slab {
+        int base;
+        int cls;
+        int in_use;
+        int free_head;          // index of the first free object, -1 if full
+        vector<int> link;       // link[i]: next free object after i, or ALLOCATED
+        int prev;               // neighbours in the class's partial list
+        int next;
+    };
+
+    static const int ALLOCATED = -2;
+
+    BuddyAllocator &pages;
+    int page_size;
+
+    vector<int> class_size;
+    vector<int> partial;                // per class: first slab with free objects
+    vector<int> empty_slab;             // per class: one cached empty slab, or -1
+
+    vector<Slab> slabs;
+    vector<int> spare_slabs;
+    unordered_map<int,int> slab_at;     // page base -> slab
+    unordered_map<int,int> requested;   // object or large block -> requested size
+
+    int live_object_bytes = 0;          // sum of class sizes handed out
+    int live_requested_bytes = 0;
+    int large_block_bytes = 0;          // buddy blocks used for large requests
+    int held_pages = 0;
+
+    int class_of(int size) const;
+    int new_slab(int cls);
+    void release_slab(int s);
+    void link_partial(int s);
+    void unlink_partial(int s);
+
+public:
+    SlabAllocator(BuddyAllocator &backing, int page_size);
+
+    int slab_malloc(int size);
+    void slab_free(int addr);
+
+    // Rounding waste: class size (or buddy block) minus requested size.
+    int get_internal_fragmentation() const;
+
+    // Free object space inside slabs currently held from the buddy allocator.
+    int get_slab_slack() const;
+
+    // Bytes taken from the buddy allocator (slab pages + large blocks).
+    int get_used_memory() const;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <vector>
+#include <string>
+#include "cache.h"
+
+// Mattson stack distances of one block stream, in one pass. The distance
+// of an access is the number of distinct blocks touched since the last
+// access to its block, so a fully associative LRU cache of C blocks hits
+// exactly the accesses with distance < C. Each block's latest access time
+// is marked in a Fenwick tree over time, and the distance is the number
+// of marks after the block's previous time: O(log n) per access. When the
+// tree fills, the live times are renumbered in order, so the tree follows
+// the number of distinct blocks rather than the length of the stream.
+// Block numbers index `last` directly; physical addresses keep them dense.
+class StackDistance {
+private:
+    std::vector<int> tree;                  // Fenwick tree over time slots
+    std::vector<int> owner;                 // time slot -> block marked there, or -1
+    std::vector<int> last;                  // block -> time of latest access, or -1
+    int now = 0;
+    long long live = 0;                     // distinct blocks so far
+
+    std::vector<long long> histogram;       // accesses per distance
+    long long cold = 0;                     // first touches
+    long long accesses = 0;
+
+    void add(int t, int delta);
+    int marks_through(int t) const;         // marks at times <= t
+    void renumber();
+
+public:
+    StackDistance();
+
+    void access(int block);
+
+    long long get_accesses() const { return accesses; }
+    long long get_cold() const { return cold; }
+    long long distinct_blocks() const { return live; }
+
+    // Largest distance seen plus one: the smallest size with cold misses only.
+    long long reach() const { return (long long)histogram.size(); }
+
+    // Misses of an LRU cache holding `blocks` blocks.
+    long long misses(long long blocks) const;
+};
+
+// Miss-ratio curves of the access stream reaching one cache level: fully
+// associative LRU for every size, and set-associative LRU for every
+// associativity at each set count asked for. A set-associative LRU cache
+// hits exactly when the distance within the access's set is below the
+// number of ways, so the per-set curves are exact for LRU and an estimate
+// for the other policies. Blocks and sets come from BlockMapping, as in
+// Cache.
+class StackProfiler {
+private:
+    int block_size;
+    StackDistance full;
+
+    struct SetCurves {
+        BlockMapping mapping;
+        std::vector<StackDistance> sets;
+    };
+    std::vector<SetCurves> per_set;
+
+public:
+    StackProfiler(int block_size, const std::vector<int> &set_counts);
+
+    void access(int address);
+
+    void print(const std::string &name) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include "replacement.h"
+
+struct SweepConfig {
+    int size;
+    int block;
+    int ways;
+    ReplacementKind policy;
+};
+
+struct SweepResult {
+    long long accesses = 0;
+    long long hits = 0;
+    long long misses = 0;
+    long long cycles = 0;
+    double seconds = 0;
+};
+
+// "<size>:<block>:<ways>[:policy]"; false with a message in `error`.
+bool parse_sweep_config(const std::string &text, SweepConfig &config, std::string &error);
+std::string sweep_config_name(const SweepConfig &config);
+
+// Simulates every configuration as a single cache over the same physical
+// addresses. Each job builds its own Cache and reads the shared buffer,
+// so the jobs run on a pool of threads (0 = one per hardware thread) with
+// nothing shared but the read-only addresses. A hit costs `hit_latency`,
+// a miss `miss_latency` on top.
+std::vector<SweepResult> run_sweep(const std::vector<int> &addrs,
+                                   const std::vector<SweepConfig> &configs,
+                                   int hit_latency, int miss_latency, int threads = 0);
+
+void print_sweep(const std::vector<SweepConfig> &configs, const std::vector<SweepResult> &results);
+bool write_sweep_csv(const std::string &path, const std::vector<SweepConfig> &configs,
+                     const std::vector<SweepResult> &results);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "replacement.h"
+
+extern int tlb_penalty;        // every lookup in the first-level TLB
+extern int tlb2_penalty;       // lookup in the second-level TLB
+extern int page_walk_penalty;  // miss in every TLB level
+
+// Set-associative translation cache from (asid, virtual page) to frame.
+// The ASID is the pid; with ASID tagging off the caller flushes on a
+// pid switch instead.
+class Tlb {
+private:
+    int entries;
+    int associativity;
+    int num_sets;
+
+    // Set s occupies [s * associativity, (s + 1) * associativity);
+    // INVALID_VPN marks an empty way.
+    std::vector<long long> vpns;
+    std::vector<int> asids;
+    std::vector<int> frames;
+    ReplacementState repl;
+
+    static constexpr long long INVALID_VPN = -1;
+
+    int set_of(long long vpn) const { return (int)(vpn % num_sets); }
+    int find_way(int set_index, int asid, long long vpn) const;
+
+    long long accesses = 0;
+    long long hits = 0;
+    long long misses = 0;
+
+public:
+    Tlb(int entries, int N, ReplacementKind policy = REPL_LRU);
+
+    // Counts the lookup; on a hit stores the frame.
+    bool lookup(int asid, long long vpn, int &frame);
+    void insert(int asid, long long vpn, int frame);
+
+    // Shootdown when a page loses its frame.
+    void invalidate(int asid, long long vpn);
+    void flush();
+
+    int get_entries() const { return entries; }
+    int get_associativity() const { return associativity; }
+    ReplacementKind get_policy() const { return repl.get_kind(); }
+
+    void print_stats(const std::string &name) const;
+};
+
+#endif
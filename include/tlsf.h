@@ -0,0 +1,35 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include "heap.h"
+
+// Two-level segregated fit index over the free blocks of a BlockHeap.
+// The first level splits sizes by power of two, the second splits each
+// power-of-two range into SL_COUNT equal classes. Bitmaps record which
+// classes are non-empty, so insert, remove and find are O(1).
+class TlsfIndex {
+public:
+    static const int SL_LOG2 = 4;
+    static const int SL_COUNT = 1 << SL_LOG2;
+    static const int FL_COUNT = 32 - SL_LOG2;
+
+private:
+    unsigned fl_bitmap = 0;
+    unsigned sl_bitmap[FL_COUNT];
+    int heads[FL_COUNT][SL_COUNT];
+
+    static void mapping_insert(unsigned size, int &fl, int &sl);
+    static void mapping_search(unsigned size, int &fl, int &sl);
+
+public:
+    TlsfIndex();
+
+    void clear();
+    void insert(BlockHeap &heap, int slot);
+    void remove(BlockHeap &heap, int slot);
+
+    // Slot of a free block of at least `size` bytes, or -1.
+    int find(int size) const;
+};
+
+#endif
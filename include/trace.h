@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Binary access trace: a 16-byte header followed by 16-byte records,
+// little-endian, as written by trace_tool.
+struct TraceHeader {
+    char magic[8];      // "MSTRACE1"
+    uint64_t count;     // number of records
+};
+
+struct TraceRecord {
+    uint64_t vaddr;
+    uint32_t pid;
+    uint32_t flags;     // TRACE_WRITE, thread id in the upper 16 bits
+};
+
+enum { TRACE_WRITE = 1, TRACE_THREAD_SHIFT = 16 };
+
+inline int trace_thread(const TraceRecord &r) { return (int)(r.flags >> TRACE_THREAD_SHIFT); }
+
+static_assert(sizeof(TraceHeader) == 16, "trace header must be 16 bytes");
+static_assert(sizeof(TraceRecord) == 16, "trace record must be 16 bytes");
+
+extern const char TRACE_MAGIC[8];
+
+// Read-only memory mapping of a trace file. Records are paged in by the
+// OS as they are read, so traces larger than RAM replay fine.
+class TraceFile {
+private:
+    const TraceRecord *records = nullptr;
+    size_t count = 0;
+
+    void *base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *map_handle = nullptr;
+#endif
+
+    void close();
+
+public:
+    TraceFile() {}
+    ~TraceFile();
+    TraceFile(const TraceFile &) = delete;
+    TraceFile &operator=(const TraceFile &) = delete;
+
+    // Maps `path`; on failure prints why and returns false.
+    bool open(const std::string &path);
+
+    const TraceRecord *begin() const { return records; }
+    const TraceRecord *end() const { return records + count; }
+    size_t size() const { return count; }
+};
+
+#endif
@@ -3,6 +3,11 @@
 
 #include <vector>
 #include <unordered_map>
+#include <string>
+#include "replacement.h"
+#include "page_policy.h"
+
+class Tlb;
 using namespace std;
 
 extern int disk_penalty;
@@ -15,9 +20,34 @@ struct PageTableEntry {
 
 void reset_vm_system(int physical_size, int page_size);
 
+// Page replacement policy by name: lru (default), fifo, clock, second,
+// arc, ws (working set over the last 'window' references of each
+// process) or opt. Resident pages are kept.
+bool set_vm_policy(const string &name, int window = 0);
+PagePolicyKind get_vm_policy();
+const char *vm_policy_name();
+int vm_policy_window();
+
+// OPT needs the future: the index of the next access to the same page,
+// for the next vm_access only (trace replay computes these). Accesses
+// without one count as never used again.
+void set_next_use(long long next_use);
+
+// Page number of vaddr in pid's page size, -1 if invalid.
+long long vm_page_number(int pid, long long vaddr);
+
+
+// radix_levels 0 gives a flat table of virtual_size / page_size entries;
+// 2-4 gives a radix tree whose inner nodes and leaves are allocated on
+// first touch, for large (up to 2^48 byte) sparse address spaces.
+// A huge_page_size (a power-of-two multiple of the page size) maps the
+// process with pages of that size, each backed by an aligned run of
+// frames.
+void init_vm(int pid, long long virtual_size, int radix_levels = 0, int huge_page_size = 0);
 
-void init_vm(int pid, int virtual_size);
-int vm_access(int pid, int vaddr);
+// 'write' marks the page dirty; evicting a dirty page costs another
+// disk_penalty for the write-back.
+int vm_access(int pid, long long vaddr, bool write = false);
 void dump_page_table(int pid);
 
 bool any_vm_initialized();
@@ -25,8 +55,40 @@ vector<int> get_initialized_pids();
 
 int get_page_hits();
 int get_page_faults();
+int get_dirty_writebacks();
+
+// Walks of radix tables cost one memory reference per level visited.
+// With a hook set, each reference is also passed on (to the caches) as a
+// physical address above simulated RAM.
+long long get_page_walk_refs();
+void set_page_walk_hook(void (*hook)(int paddr));
+bool page_walk_hook_set();
+
+// Sweep support: begin sets the page tables, frames, replacement and TLB
+// state and the VM counters aside and starts over with the same
+// processes, table shapes and policies but nothing mapped (or pinned);
+// end drops that scratch state and puts the saved one back.
+void begin_vm_scratch();
+void end_vm_scratch();
 
 int get_used_frames(int pid);
 int get_total_frames();
 
+// Pinned pages stay resident; both fail if the page is not resident
+// (or, for unpin, not pinned).
+bool vm_pin(int pid, long long vaddr);
+bool vm_unpin(int pid, long long vaddr);
+
+// TLB in front of the page tables. Configuring level 1 starts a new,
+// empty hierarchy (any level 2 is dropped); level 2 is then added behind
+// it. 'asid' tags entries with the pid, otherwise a pid switch flushes
+// both levels. reset_vm_system drops them.
+bool configure_tlb(int level, int entries, int ways, ReplacementKind policy, bool asid = true);
+void disable_tlb();
+bool tlb_enabled();
+bool tlb_asid_tagged();
+const Tlb *get_tlb(int level);
+long long get_page_walks();
+long long get_tlb_flushes();
+
 #endif
\ No newline at end of file
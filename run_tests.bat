@@ -25,11 +25,86 @@ echo ===== CACHE ACCESS TEST ===== >> all_tests_output.txt
 memsim.exe < test\cache_access_test.txt > output\cache_log.txt
 type output\cache_log.txt >> all_tests_output.txt
 
+echo Running Cache policy test...
+echo ===== CACHE POLICY TEST ===== >> all_tests_output.txt
+memsim.exe < test\cache_policy_test.txt > output\cache_policy_log.txt
+type output\cache_policy_log.txt >> all_tests_output.txt
+
 echo Running VM access test...
 echo ===== VM ACCESS TEST ===== >> all_tests_output.txt
 memsim.exe < test\vm_access_test.txt > output\vm_log.txt
 type output\vm_log.txt >> all_tests_output.txt
 
+echo Running wide FIFO cache test...
+echo ===== WIDE FIFO CACHE TEST ===== >> all_tests_output.txt
+memsim.exe < test\cache_fifo_ways_test.txt > output\cache_fifo_ways_log.txt
+type output\cache_fifo_ways_log.txt >> all_tests_output.txt
+
+echo Running trace replay test...
+trace_tool.exe encode test\replay_trace.txt test\replay_trace.bin > nul
+echo ===== TRACE REPLAY TEST ===== >> all_tests_output.txt
+memsim.exe < test\trace_replay_test.txt > output\trace_replay_log.txt
+type output\trace_replay_log.txt >> all_tests_output.txt
+
+echo Running verbosity test...
+echo ===== VERBOSITY TEST ===== >> all_tests_output.txt
+memsim.exe < test\verbosity_test.txt > output\verbosity_log.txt
+echo.>> output\verbosity_log.txt
+echo ----- Decoded event log ----- >> output\verbosity_log.txt
+trace_tool.exe events output\verbosity_events.bin >> output\verbosity_log.txt
+type output\verbosity_log.txt >> all_tests_output.txt
+
+echo Running VM policy test...
+echo ===== VM POLICY TEST ===== >> all_tests_output.txt
+memsim.exe < test\vm_policy_test.txt > output\vm_policy_log.txt
+type output\vm_policy_log.txt >> all_tests_output.txt
+
+echo Running TLB test...
+echo ===== TLB TEST ===== >> all_tests_output.txt
+memsim.exe < test\tlb_test.txt > output\tlb_log.txt
+type output\tlb_log.txt >> all_tests_output.txt
+
+echo Running radix page table test...
+echo ===== RADIX PAGE TABLE TEST ===== >> all_tests_output.txt
+memsim.exe < test\radix_vm_test.txt > output\radix_vm_log.txt
+type output\radix_vm_log.txt >> all_tests_output.txt
+
+echo Running huge page test...
+echo ===== HUGE PAGE TEST ===== >> all_tests_output.txt
+memsim.exe < test\huge_page_test.txt > output\huge_page_log.txt
+type output\huge_page_log.txt >> all_tests_output.txt
+
+echo Running page policy test...
+echo ===== PAGE POLICY TEST ===== >> all_tests_output.txt
+memsim.exe < test\page_policy_test.txt > output\page_policy_log.txt
+type output\page_policy_log.txt >> all_tests_output.txt
+
+echo Running coherence test...
+echo ===== COHERENCE TEST ===== >> all_tests_output.txt
+memsim.exe < test\coherence_test.txt > output\coherence_log.txt
+type output\coherence_log.txt >> all_tests_output.txt
+
+echo Running prefetch test...
+echo ===== PREFETCH TEST ===== >> all_tests_output.txt
+memsim.exe < test\prefetch_test.txt > output\prefetch_log.txt
+type output\prefetch_log.txt >> all_tests_output.txt
+
+echo Running cache hierarchy test...
+echo ===== CACHE HIERARCHY TEST ===== >> all_tests_output.txt
+memsim.exe < test\hierarchy_test.txt > output\hierarchy_log.txt
+type output\hierarchy_log.txt >> all_tests_output.txt
+
+echo Running stack distance test...
+echo ===== STACK DISTANCE TEST ===== >> all_tests_output.txt
+memsim.exe < test\stack_profile_test.txt > output\stack_profile_log.txt
+type output\stack_profile_log.txt >> all_tests_output.txt
+
+echo Running cache sweep test...
+trace_tool.exe encode test\sweep_trace.txt test\sweep_trace.bin > nul
+echo ===== CACHE SWEEP TEST ===== >> all_tests_output.txt
+memsim.exe < test\sweep_test.txt > output\sweep_log.txt
+type output\sweep_log.txt >> all_tests_output.txt
+
 echo All test done
 echo combined output with logs is in all_test_output.txt file
 echo individual test output with logs is in output folder.
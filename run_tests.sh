@@ -26,9 +26,84 @@ echo "===== CACHE ACCESS TEST =====" >> all_tests_output.txt
 ./memsim < test/cache_access_test.txt > output/cache_log.txt
 cat output/cache_log.txt >> all_tests_output.txt
 
+echo "Running Cache policy test..."
+echo "===== CACHE POLICY TEST =====" >> all_tests_output.txt
+./memsim < test/cache_policy_test.txt > output/cache_policy_log.txt
+cat output/cache_policy_log.txt >> all_tests_output.txt
+
 echo "Running VM access test..."
 echo "===== VM ACCESS TEST =====" >> all_tests_output.txt
 ./memsim < test/vm_access_test.txt > output/vm_log.txt
 cat output/vm_log.txt >> all_tests_output.txt
 
+echo "Running wide FIFO cache test..."
+echo "===== WIDE FIFO CACHE TEST =====" >> all_tests_output.txt
+./memsim < test/cache_fifo_ways_test.txt > output/cache_fifo_ways_log.txt
+cat output/cache_fifo_ways_log.txt >> all_tests_output.txt
+
+echo "Running trace replay test..."
+./trace_tool encode test/replay_trace.txt test/replay_trace.bin > /dev/null
+echo "===== TRACE REPLAY TEST =====" >> all_tests_output.txt
+./memsim < test/trace_replay_test.txt > output/trace_replay_log.txt
+cat output/trace_replay_log.txt >> all_tests_output.txt
+
+echo "Running verbosity test..."
+echo "===== VERBOSITY TEST =====" >> all_tests_output.txt
+./memsim < test/verbosity_test.txt > output/verbosity_log.txt
+echo "" >> output/verbosity_log.txt
+echo "----- Decoded event log -----" >> output/verbosity_log.txt
+./trace_tool events output/verbosity_events.bin >> output/verbosity_log.txt
+cat output/verbosity_log.txt >> all_tests_output.txt
+
+echo "Running VM policy test..."
+echo "===== VM POLICY TEST =====" >> all_tests_output.txt
+./memsim < test/vm_policy_test.txt > output/vm_policy_log.txt
+cat output/vm_policy_log.txt >> all_tests_output.txt
+
+echo "Running TLB test..."
+echo "===== TLB TEST =====" >> all_tests_output.txt
+./memsim < test/tlb_test.txt > output/tlb_log.txt
+cat output/tlb_log.txt >> all_tests_output.txt
+
+echo "Running radix page table test..."
+echo "===== RADIX PAGE TABLE TEST =====" >> all_tests_output.txt
+./memsim < test/radix_vm_test.txt > output/radix_vm_log.txt
+cat output/radix_vm_log.txt >> all_tests_output.txt
+
+echo "Running huge page test..."
+echo "===== HUGE PAGE TEST =====" >> all_tests_output.txt
+./memsim < test/huge_page_test.txt > output/huge_page_log.txt
+cat output/huge_page_log.txt >> all_tests_output.txt
+
+echo "Running page policy test..."
+echo "===== PAGE POLICY TEST =====" >> all_tests_output.txt
+./memsim < test/page_policy_test.txt > output/page_policy_log.txt
+cat output/page_policy_log.txt >> all_tests_output.txt
+
+echo "Running coherence test..."
+echo "===== COHERENCE TEST =====" >> all_tests_output.txt
+./memsim < test/coherence_test.txt > output/coherence_log.txt
+cat output/coherence_log.txt >> all_tests_output.txt
+
+echo "Running prefetch test..."
+echo "===== PREFETCH TEST =====" >> all_tests_output.txt
+./memsim < test/prefetch_test.txt > output/prefetch_log.txt
+cat output/prefetch_log.txt >> all_tests_output.txt
+
+echo "Running cache hierarchy test..."
+echo "===== CACHE HIERARCHY TEST =====" >> all_tests_output.txt
+./memsim < test/hierarchy_test.txt > output/hierarchy_log.txt
+cat output/hierarchy_log.txt >> all_tests_output.txt
+
+echo "Running stack distance test..."
+echo "===== STACK DISTANCE TEST =====" >> all_tests_output.txt
+./memsim < test/stack_profile_test.txt > output/stack_profile_log.txt
+cat output/stack_profile_log.txt >> all_tests_output.txt
+
+echo "Running cache sweep test..."
+./trace_tool encode test/sweep_trace.txt test/sweep_trace.bin > /dev/null
+echo "===== CACHE SWEEP TEST =====" >> all_tests_output.txt
+./memsim < test/sweep_test.txt > output/sweep_log.txt
+cat output/sweep_log.txt >> all_tests_output.txt
+
 echo "Done! All logs saved — nothing printed to screen."
@@ -1,8 +1,8 @@
 #include "../include/buddy.h"
-#include "../include/memory.h"   
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
@@ -20,7 +20,8 @@ int BuddyAllocator::size_to_order(int size) {
     return order;
 }
 
-BuddyAllocator::BuddyAllocator(int memory_size, int min_block_size) {
+BuddyAllocator::BuddyAllocator(int memory_size, int min_block_size, HandleTable *handles)
+    : handles(handles) {
     if (!is_power_of_two(memory_size) || !is_power_of_two(min_block_size)) {
         throw runtime_error("Sizes must be power of two");
     }
@@ -29,8 +30,59 @@ BuddyAllocator::BuddyAllocator(int memory_size, int min_block_size) {
     min_order = size_to_order(min_block_size);
     max_order = size_to_order(memory_size);
 
-    free_list.resize(max_order + 1);
-    free_list[max_order].push_back(0);
+    int blocks = max(1, memory_size >> min_order);
+    link_prev.assign(blocks, -1);
+    link_next.assign(blocks, -1);
+    free_head.assign(max_order + 1, -1);
+    free_tail.assign(max_order + 1, -1);
+
+    // Orders below min_order never hold a block, so they get no bitmap;
+    // a heap smaller than min_block_size is one block of max_order.
+    free_bits.resize(max_order + 1);
+    for (int o = min(min_order, max_order); o <= max_order; o++)
+        free_bits[o].assign(((memory_size >> o) + 63) / 64 + 1, 0);
+
+    push_free(max_order, 0);
+}
+
+bool BuddyAllocator::is_free(int order, int addr) const {
+    int i = addr >> order;
+    return (free_bits[order][i >> 6] >> (i & 63)) & 1;
+}
+
+void BuddyAllocator::push_free(int order, int addr) {
+    int i = addr >> min_order;
+    link_prev[i] = free_tail[order];
+    link_next[i] = -1;
+
+    if (free_tail[order] != -1)
+        link_next[free_tail[order] >> min_order] = addr;
+    else
+        free_head[order] = addr;
+    free_tail[order] = addr;
+
+    int b = addr >> order;
+    free_bits[order][b >> 6] |= (uint64_t)1 << (b & 63);
+}
+
+void BuddyAllocator::remove_free(int order, int addr) {
+    int i = addr >> min_order;
+    int p = link_prev[i];
+    int n = link_next[i];
+
+    if (p != -1) link_next[p >> min_order] = n;
+    else         free_head[order] = n;
+    if (n != -1) link_prev[n >> min_order] = p;
+    else         free_tail[order] = p;
+
+    int b = addr >> order;
+    free_bits[order][b >> 6] &= ~((uint64_t)1 << (b & 63));
+}
+
+int BuddyAllocator::pop_free(int order) {
+    int addr = free_head[order];
+    remove_free(order, addr);
+    return addr;
 }
 
 int BuddyAllocator::buddy_malloc(int size) {
@@ -39,26 +91,26 @@ int BuddyAllocator::buddy_malloc(int size) {
         req_order = min_order;
 
     int cur_order = req_order;
-    while (cur_order <= max_order && free_list[cur_order].empty())
+    while (cur_order <= max_order && free_head[cur_order] == -1)
         cur_order++;
 
     if (cur_order > max_order)
         return -1;
 
-    int addr = free_list[cur_order].front();
-    free_list[cur_order].pop_front();
+    int addr = pop_free(cur_order);
 
     while (cur_order > req_order) {
         cur_order--;
         int buddy = addr + (1 << cur_order);
-        free_list[cur_order].push_back(buddy);
+        push_free(cur_order, buddy);
     }
 
     allocated_order[addr] = req_order;
     requested_size[addr] = size;
     used_memory += (1 << req_order);
 
-    buddy_ids[addr] = next_block_id++;
+    if (handles)
+        handles->issue(addr, HandleTable::BUDDY);
 
     return addr;
 }
@@ -71,24 +123,22 @@ void BuddyAllocator::buddy_free(int addr) {
     used_memory -= (1 << order);
     allocated_order.erase(addr);
     requested_size.erase(addr);
-    buddy_ids.erase(addr);
+    if (handles)
+        handles->release(addr);
 
     while (order < max_order) {
         int block_size = 1 << order;
         int buddy = addr ^ block_size;
 
-        auto &lst = free_list[order];
-        auto it = find(lst.begin(), lst.end(), buddy);
-
-        if (it == lst.end())
+        if (!is_free(order, buddy))
             break;
 
-        lst.erase(it);
+        remove_free(order, buddy);
         addr = min(addr, buddy);
         order++;
     }
 
-    free_list[order].push_back(addr);
+    push_free(order, addr);
 }
 
 int BuddyAllocator::get_used_memory() const {
@@ -104,10 +154,10 @@ int BuddyAllocator::get_order(int addr) const {
 void BuddyAllocator::dump_free_lists() {
     cout << "---- Buddy Free Lists ----\n";
     for (int i = min_order; i <= max_order; i++) {
-        if(free_list[i].size()!=0){
+        if(free_head[i]!=-1){
         cout << "Order " << i << " (size " << (1 << i) << "): ";
         
-        for (int addr : free_list[i])
+        for (int addr = free_head[i]; addr != -1; addr = link_next[addr >> min_order])
             cout << "0x" << hex << addr << dec << " ";
         cout << "\n";
         }
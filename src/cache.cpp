@@ -1,64 +1,200 @@
 #include "../include/cache.h"
 #include <iostream>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace std;
-int l1_penalty   = 1;
-int l2_penalty   = 5;
-int memory_penalty = 50;
 
-int total_cycles = 0;
+long long total_cycles = 0;
 
-Cache::Cache(int C, int b, int N)
-    : cache_size(C), block_size(b), associativity(N) {
+Cache::Cache(int C, int b, int N, ReplacementKind policy)
+    : cache_size(C), mapping{b, C / b / N}, associativity(N),
+      stride((N + 3) & ~3),
+      tags((size_t)mapping.num_sets * stride, INVALID_TAG),
+      repl(policy, mapping.num_sets, N) {
+}
 
-    int blocks = cache_size / block_size;
-    num_sets = blocks / associativity;
+// Way holding `tag` in the set, or -1. Compares 8 (AVX2) or 4 (SSE2)
+// ways at a time; the padding up to `stride` holds INVALID_TAG and never
+// matches.
+int Cache::find_way(int set_index, int tag) const {
+    const int *ways = &tags[(size_t)set_index * stride];
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i t8 = _mm256_set1_epi32(tag);
+    for (; i + 8 <= stride; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(ways + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, t8)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+#if defined(__SSE2__)
+    __m128i t4 = _mm_set1_epi32(tag);
+    for (; i < stride; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(ways + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, t4)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#else
+    for (; i < associativity; i++) {
+        if (ways[i] == tag)
+            return i;
+    }
+#endif
 
-    sets.resize(num_sets, vector<CacheLine>(associativity, {false, -1}));
-    fifo.resize(num_sets);
+    return -1;
 }
 
 bool Cache::access(int address) {
-    accesses++;
+    if (lookup(address))
+        return true;
 
-    int block_number = address / block_size;
-    int set_index = block_number % num_sets;
-    int tag = block_number / num_sets;
+    insert(address);
+    return false; 
+}
 
-    for (auto &line : sets[set_index]) {
-        if (line.valid && line.tag == tag) {
-            hits++;
-            return true; 
+bool Cache::lookup(int address) {
+    accesses++;
+
+    int block_number = mapping.block(address);
+    int set_index = mapping.set(block_number);
+    int tag = mapping.tag(block_number);
+
+    int way = find_way(set_index, tag);
+    if (way != -1) {
+        hits++;
+        repl.on_hit(set_index, way);
+
+        if (prefetcher) {
+            size_t line = (size_t)set_index * stride + way;
+            bool first_use = prefetched[line];
+
+            if (first_use) {
+                prefetched[line] = 0;
+                pf_useful++;
+
+                if (ready_at[line] > total_cycles) {
+                    long long stall = ready_at[line] - total_cycles;
+                    pf_late++;
+                    pf_late_cycles += stall;
+                    total_cycles += stall;
+                }
+            }
+            prefetcher->on_access(address, first_use, proposed);
         }
+        return true; 
     }
 
     misses++;
-    insert(address);
+
+    if (prefetcher) {
+        int &slot = polluters[block_number % polluters.size()];
+        if (slot == block_number) {
+            pf_polluting++;
+            slot = -1;
+        }
+        prefetcher->on_access(address, true, proposed);
+    }
     return false; 
 }
 
-void Cache::insert(int address) {
-    int block_number = address / block_size;
-    int set_index = block_number % num_sets;
-    int tag = block_number / num_sets;
+int Cache::insert(int address) {
+    return fill(address, false, 0);
+}
+
+int Cache::prefetch_fill(int address, long long ready) {
+    pf_issued++;
+    return fill(address, true, ready);
+}
+
+int Cache::fill(int address, bool by_prefetch, long long ready) {
+    int block_number = mapping.block(address);
+    int set_index = mapping.set(block_number);
+    int tag = mapping.tag(block_number);
+
 
+    int *ways = &tags[(size_t)set_index * stride];
+    int way = -1;
+    int evicted = -1;
 
     for (int i = 0; i < associativity; i++) {
-        if (!sets[set_index][i].valid) {
-            sets[set_index][i] = {true, tag};
-            fifo[set_index].push(i);
-            return;
+        if (ways[i] == INVALID_TAG) {
+            way = i;
+            break;
         }
     }
 
-    int victim = fifo[set_index].front();
-    fifo[set_index].pop();
+    if (way == -1) {
+        way = repl.victim(set_index);
+        evicted = mapping.address(set_index, ways[way]);
+    }
+
+    ways[way] = tag;
+    repl.on_fill(set_index, way);
 
-    sets[set_index][victim] = {true, tag};
-    fifo[set_index].push(victim);
+    if (prefetcher) {
+        size_t line = (size_t)set_index * stride + way;
+
+        if (evicted != -1) {
+            if (prefetched[line])
+                pf_unused++;
+            else if (by_prefetch)
+                polluters[mapping.block(evicted) % polluters.size()] = mapping.block(evicted);
+        }
+        prefetched[line] = by_prefetch;
+        ready_at[line] = ready;
+    }
+    return evicted;
+}
+
+bool Cache::invalidate(int address) {
+    int block_number = mapping.block(address);
+    int set_index = mapping.set(block_number);
+    int tag = mapping.tag(block_number);
+
+    int way = find_way(set_index, tag);
+    if (way == -1)
+        return false;
+
+    tags[(size_t)set_index * stride + way] = INVALID_TAG;
+    if (prefetcher)
+        prefetched[(size_t)set_index * stride + way] = 0;
+    return true;
+}
+
+bool Cache::contains(int address) const {
+    int block_number = mapping.block(address);
+    return find_way(mapping.set(block_number), mapping.tag(block_number)) != -1;
+}
+
+void Cache::set_prefetcher(PrefetchKind kind, int page_size, int degree, int distance) {
+    prefetcher.reset();
+    prefetched.clear();
+    ready_at.clear();
+    polluters.clear();
+    proposed.clear();
+    pf_issued = pf_useful = pf_late = pf_late_cycles = pf_unused = pf_polluting = 0;
+
+    if (kind == PF_NONE)
+        return;
+
+    // Lines already present count as demand fills.
+    prefetcher.reset(new Prefetcher(kind, mapping.block_size, page_size, degree, distance));
+    prefetched.assign(tags.size(), 0);
+    ready_at.assign(tags.size(), 0);
+    polluters.assign((size_t)mapping.num_sets * associativity, -1);
 }
 
 void Cache::print_stats(const string &name) const {
+    cout << name << " Policy: " << replacement_name(repl.get_kind()) << "\n";
     cout << name << " Accesses: " << accesses << "\n";
     cout << name << " Hits: " << hits << "\n";
     cout << name << " Misses: " << misses << "\n";
@@ -66,4 +202,24 @@ void Cache::print_stats(const string &name) const {
     if (accesses > 0)
         cout << name << " Hit Ratio: "
              << (hits * 100.0 / accesses) << "%\n";
+
+    if (!prefetcher)
+        return;
+
+    // Accuracy: used prefetches per issued one. Coverage: share of the
+    // would-be misses that a prefetch turned into hits.
+    cout << name << " Prefetcher: " << prefetch_name(prefetcher->get_kind())
+         << " (degree " << prefetcher->get_degree()
+         << ", distance " << prefetcher->get_distance() << ")\n";
+    cout << name << " Prefetches Issued: " << pf_issued << "\n";
+    cout << name << " Prefetches Useful: " << pf_useful;
+    if (pf_issued > 0)
+        cout << " (accuracy " << (pf_useful * 100.0 / pf_issued) << "%)";
+    if (pf_useful + misses > 0)
+        cout << " (coverage " << (pf_useful * 100.0 / (pf_useful + misses)) << "%)";
+    cout << "\n";
+    cout << name << " Prefetches Late: " << pf_late
+         << " (stall cycles " << pf_late_cycles << ")\n";
+    cout << name << " Prefetches Unused: " << pf_unused << "\n";
+    cout << name << " Polluting Prefetches: " << pf_polluting << "\n";
 }
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "../include/coherence.h"
+#include "../include/events.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+CoherentCaches::CoherentCaches(int cores, CacheHierarchy &shared)
+    : cores(cores), block_size(shared.level(0).get_block_size()),
+      word_bytes(max(4, block_size / 64)), shared(shared), stats(cores) {
+    Cache &geometry = shared.level(0);
+    for (int c = 0; c < cores; c++)
+        l1.emplace_back(new Cache(geometry.get_size(), block_size,
+                                  geometry.get_associativity(), geometry.get_policy()));
+}
+
+int CoherentCaches::core_of(int pid, int thread) {
+    auto it = core_of_stream.find({pid, thread});
+    if (it != core_of_stream.end())
+        return it->second;
+
+    int core = (int)(core_of_stream.size() % cores);
+    core_of_stream[{pid, thread}] = core;
+    return core;
+}
+
+// Every copy but `core`'s is invalidated; an M copy is written back.
+void CoherentCaches::invalidate_others(DirEntry &d, int block, int core) {
+    uint64_t others = d.sharers & ~(1ULL << core);
+
+    for (int s = 0; others; s++, others >>= 1) {
+        if (!(others & 1))
+            continue;
+
+        l1[s]->invalidate(block * block_size);
+        emit_event(EV_L1_INVALIDATE, -1, (long long)block * block_size, s);
+        stats[s].invalidated++;
+        invalidations++;
+        if (d.owner == s && d.dirty)
+            stats[s].writebacks++;
+
+        d.lost |= 1ULL << s;
+        remote_words[lost_key(block, s)] = 0;
+    }
+
+    d.sharers &= 1ULL << core;
+    if (d.owner != core) {
+        d.owner = -1;
+        d.dirty = false;
+    }
+}
+
+// Remembers the written word for every core that lost its copy, so its
+// next miss can tell true from false sharing.
+void CoherentCaches::record_write(DirEntry &d, int block, int core, int word) {
+    uint64_t lost = d.lost & ~(1ULL << core);
+
+    for (int s = 0; lost; s++, lost >>= 1)
+        if (lost & 1)
+            remote_words[lost_key(block, s)] |= 1ULL << word;
+}
+
+void CoherentCaches::classify_coherence_miss(DirEntry &d, int block, int core, int word) {
+    auto it = remote_words.find(lost_key(block, core));
+    uint64_t written = it != remote_words.end() ? it->second : 0;
+    if (it != remote_words.end())
+        remote_words.erase(it);
+
+    d.lost &= ~(1ULL << core);
+    stats[core].coherence_misses++;
+
+    if ((written >> word) & 1) {
+        true_sharing++;
+    }
+    else {
+        false_sharing++;
+        false_sharing_lines[block]++;
+    }
+}
+
+// `core` evicted its copy of `block`.
+void CoherentCaches::drop(int block, int core) {
+    auto it = directory.find(block);
+    if (it == directory.end())
+        return;
+
+    DirEntry &d = it->second;
+    if (d.owner == core) {
+        if (d.dirty)
+            stats[core].writebacks++;
+        d.owner = -1;
+        d.dirty = false;
+    }
+    d.sharers &= ~(1ULL << core);
+
+    if (d.sharers == 0 && d.lost == 0)
+        directory.erase(it);
+}
+
+// Drops the L1 copies of blocks an inclusive shared level evicted.
+void CoherentCaches::drop_back_invalidated() {
+    auto &removed = shared.back_invalidated();
+
+    for (auto &r : removed) {
+        for (int a = r.first; a < r.first + r.second; a += block_size) {
+            for (int c = 0; c < cores; c++) {
+                if (l1[c]->invalidate(a)) {
+                    back_invalidations++;
+                    drop(a / block_size, c);
+                }
+            }
+        }
+    }
+    removed.clear();
+}
+
+long long CoherentCaches::access(int core, int addr, bool write) {
+    int block = addr / block_size;
+    int word = (addr % block_size) / word_bytes;
+    uint64_t me = 1ULL << core;
+
+    CoreStats &cs = stats[core];
+    long long cycles = shared.get_latency(0);
+    cs.accesses++;
+
+    if (l1[core]->lookup(addr)) {
+        cs.hits++;
+
+        if (write) {
+            DirEntry &d = directory[block];
+            if (d.owner != core) {
+                // S -> M: the other sharers have to go.
+                cs.upgrades++;
+                cycles += shared.get_latency(1);
+                invalidate_others(d, block, core);
+            }
+            d.sharers = me;
+            d.owner = core;
+            d.dirty = true;
+            record_write(d, block, core, word);
+        }
+
+        emit_event(EV_L1_HIT, -1, addr, -1);
+        cs.cycles += cycles;
+        return cycles;
+    }
+
+    cs.misses++;
+
+    // Make room first: dropping the victim may erase directory entries.
+    int evicted = l1[core]->insert(addr);
+    if (evicted != -1)
+        drop(evicted / block_size, core);
+
+    DirEntry &d = directory[block];
+    if (d.lost & me)
+        classify_coherence_miss(d, block, core, word);
+
+    int supplier = (d.owner != -1 && d.dirty) ? d.owner : -1;
+    if (supplier != -1)
+        transfers++;
+
+    if (write) {
+        invalidate_others(d, block, core);
+        d.sharers = me;
+        d.owner = core;
+        d.dirty = true;
+        record_write(d, block, core, word);
+    }
+    else {
+        // An E or M copy elsewhere drops to S.
+        if (d.owner != -1) {
+            if (d.dirty)
+                stats[d.owner].writebacks++;
+            d.owner = -1;
+            d.dirty = false;
+        }
+        if (d.sharers == 0)
+            d.owner = core;
+        d.sharers |= me;
+    }
+
+    if (supplier != -1) {
+        // The owner's L1 supplies the line through the directory; the
+        // shared levels are not consulted.
+        cycles += shared.get_latency(1);
+        emit_event(EV_L1_TRANSFER, -1, addr, supplier);
+    }
+    else {
+        cycles += shared.access(addr, 1);
+        drop_back_invalidated();
+    }
+
+    cs.cycles += cycles;
+    return cycles;
+}
+
+void CoherentCaches::print_stats() const {
+    ios state(nullptr);
+    state.copyfmt(cout);
+
+    cout << "Cores: " << cores << " (private L1s, shared L2, MESI directory)\n";
+    cout << left
+         << setw(6) << "Core"
+         << setw(11) << "Accesses"
+         << setw(9) << "L1Hits"
+         << setw(10) << "L1Misses"
+         << setw(11) << "Coherence"
+         << setw(10) << "Upgrades"
+         << setw(13) << "Invalidated"
+         << setw(12) << "Writebacks"
+         << "Cycles\n";
+
+    long long slowest = 0;
+    for (int c = 0; c < cores; c++) {
+        const CoreStats &s = stats[c];
+        cout << setw(6) << c
+             << setw(11) << s.accesses
+             << setw(9) << s.hits
+             << setw(10) << s.misses
+             << setw(11) << s.coherence_misses
+             << setw(10) << s.upgrades
+             << setw(13) << s.invalidated
+             << setw(12) << s.writebacks
+             << s.cycles << "\n";
+        slowest = max(slowest, s.cycles);
+    }
+    cout.copyfmt(state);
+
+    cout << "Invalidations: " << invalidations << "\n";
+    cout << "Cache-to-cache transfers: " << transfers << "\n";
+    if (back_invalidations > 0)
+        cout << "Inclusion back-invalidations: " << back_invalidations << "\n";
+    cout << "Coherence misses: " << true_sharing + false_sharing
+         << " (true sharing " << true_sharing << ", false sharing " << false_sharing << ")\n";
+    cout << "Slowest core cycles: " << slowest << "\n";
+
+    if (false_sharing_lines.empty())
+        return;
+
+    // Hottest lines first, lowest address on ties.
+    vector<pair<long long, int>> hot;
+    for (auto &e : false_sharing_lines)
+        hot.push_back({-e.second, e.first});
+    sort(hot.begin(), hot.end());
+
+    cout << "False-sharing hot lines:\n";
+    for (size_t i = 0; i < hot.size() && i < 5; i++)
+        cout << "  0x" << hex << (long long)hot[i].second * block_size << dec
+             << ": " << -hot[i].first << " misses\n";
+}
@@ -0,0 +1,248 @@
+#include "../include/concurrent_buddy.h"
+#include <stdexcept>
+
+using namespace std;
+
+ConcurrentBuddyAllocator::ThreadCache::ThreadCache(ConcurrentBuddyAllocator &a)
+    : owner(a) {
+    for (auto &mag : loaded)
+        mag.reserve(MAGAZINE_SIZE);
+}
+
+ConcurrentBuddyAllocator::ThreadCache::~ThreadCache() {
+    for (int s = 0; s < CACHED_ORDERS; s++)
+        owner.release_blocks(loaded[s], owner.min_order + s);
+}
+
+ConcurrentBuddyAllocator::ConcurrentBuddyAllocator(int memory_size, int min_block_size) {
+    if (memory_size <= 0 || (memory_size & (memory_size - 1)) ||
+        min_block_size <= 0 || (min_block_size & (min_block_size - 1))) {
+        throw runtime_error("Sizes must be power of two");
+    }
+
+    min_order = size_to_order(min_block_size);
+    max_order = size_to_order(memory_size);
+
+    num_blocks = max(1, memory_size >> min_order);
+    link_prev.assign(num_blocks, -1);
+    link_next.assign(num_blocks, -1);
+    block_order.reset(new atomic<int8_t>[num_blocks]);
+    for (int i = 0; i < num_blocks; i++)
+        block_order[i].store(-1, memory_order_relaxed);
+
+    // As in BuddyAllocator, orders below min_order get no bitmap.
+    lists.reset(new OrderList[max_order + 1]);
+    for (int o = min(min_order, max_order); o <= max_order; o++)
+        lists[o].bits.assign(((memory_size >> o) + 63) / 64 + 1, 0);
+
+    push_free(max_order, 0);
+}
+
+int ConcurrentBuddyAllocator::size_to_order(int size) const {
+    return size > 1 ? 32 - __builtin_clz((unsigned)(size - 1)) : 0;
+}
+
+bool ConcurrentBuddyAllocator::is_free(int order, int addr) const {
+    int b = addr >> order;
+    return (lists[order].bits[b >> 6] >> (b & 63)) & 1;
+}
+
+void ConcurrentBuddyAllocator::push_free(int order, int addr) {
+    OrderList &l = lists[order];
+    int i = addr >> min_order;
+    link_prev[i] = -1;
+    link_next[i] = l.head;
+    if (l.head != -1)
+        link_prev[l.head >> min_order] = addr;
+    l.head = addr;
+
+    int b = addr >> order;
+    l.bits[b >> 6] |= (uint64_t)1 << (b & 63);
+}
+
+void ConcurrentBuddyAllocator::remove_free(int order, int addr) {
+    OrderList &l = lists[order];
+    int i = addr >> min_order;
+    int p = link_prev[i];
+    int n = link_next[i];
+
+    if (p != -1) link_next[p >> min_order] = n;
+    else         l.head = n;
+    if (n != -1) link_prev[n >> min_order] = p;
+
+    int b = addr >> order;
+    l.bits[b >> 6] &= ~((uint64_t)1 << (b & 63));
+}
+
+// Takes a free block of `order`, splitting a larger one if needed. Each
+// order's lock is held only while its list is read or changed. Blocks
+// being split or merged by other threads are in no list meanwhile, so
+// a request can fail while memory is nearly exhausted even though
+// enough would be free a moment later.
+int ConcurrentBuddyAllocator::take_block(int order) {
+    int cur = order;
+    int addr = -1;
+    for (; cur <= max_order; cur++) {
+        OrderList &l = lists[cur];
+        lock_guard<mutex> g(l.lock);
+        l.locks++;
+        if (l.head != -1) {
+            addr = l.head;
+            remove_free(cur, addr);
+            break;
+        }
+    }
+    if (addr == -1)
+        return -1;
+
+    // The upper halves go back down; the lower half is this thread's.
+    while (cur > order) {
+        cur--;
+        OrderList &l = lists[cur];
+        lock_guard<mutex> g(l.lock);
+        l.locks++;
+        push_free(cur, addr + (1 << cur));
+    }
+
+    used_memory += 1 << order;
+    return addr;
+}
+
+// Returns a block, merging it with free buddies order by order.
+void ConcurrentBuddyAllocator::give_block(int order, int addr) {
+    used_memory -= 1 << order;
+
+    for (;; order++) {
+        OrderList &l = lists[order];
+        lock_guard<mutex> g(l.lock);
+        l.locks++;
+
+        int buddy = addr ^ (1 << order);
+        if (order == max_order || !is_free(order, buddy)) {
+            push_free(order, addr);
+            return;
+        }
+
+        remove_free(order, buddy);
+        addr = min(addr, buddy);
+    }
+}
+
+void ConcurrentBuddyAllocator::release_blocks(vector<int> &blocks, int order) {
+    for (int addr : blocks)
+        give_block(order, addr);
+    blocks.clear();
+}
+
+// Loads an empty magazine: a full one from the depot if there is one,
+// otherwise a batch taken from the free lists.
+void ConcurrentBuddyAllocator::refill(ThreadCache &tc, int slot) {
+    vector<int> &mag = tc.loaded[slot];
+
+    {
+        Depot &d = depots[slot];
+        lock_guard<mutex> g(d.lock);
+        if (!d.full.empty()) {
+            mag.swap(d.full.back());
+            d.full.pop_back();
+            return;
+        }
+    }
+
+    int order = min_order + slot;
+    while ((int)mag.size() < MAGAZINE_SIZE) {
+        int addr = take_block(order);
+        if (addr == -1)
+            break;
+        mag.push_back(addr);
+    }
+}
+
+// Parks a full magazine in the depot; if the depot is at its limit the
+// magazine goes back to the free lists instead.
+void ConcurrentBuddyAllocator::flush(ThreadCache &tc, int slot) {
+    vector<int> &mag = tc.loaded[slot];
+
+    {
+        Depot &d = depots[slot];
+        lock_guard<mutex> g(d.lock);
+        if ((int)d.full.size() < DEPOT_LIMIT) {
+            d.full.emplace_back();
+            d.full.back().reserve(MAGAZINE_SIZE);
+            d.full.back().swap(mag);
+            return;
+        }
+    }
+
+    release_blocks(mag, min_order + slot);
+}
+
+int ConcurrentBuddyAllocator::buddy_malloc(ThreadCache &tc, int size) {
+    int order = max(size_to_order(size), min_order);
+    if (order > max_order)
+        return -1;
+
+    int addr;
+    int slot = order - min_order;
+
+    if (slot < CACHED_ORDERS) {
+        vector<int> &mag = tc.loaded[slot];
+        if (mag.empty())
+            refill(tc, slot);
+        if (mag.empty())
+            return -1;
+        addr = mag.back();
+        mag.pop_back();
+    } else {
+        addr = take_block(order);
+        if (addr == -1)
+            return -1;
+    }
+
+    block_order[addr >> min_order].store((int8_t)order, memory_order_relaxed);
+    return addr;
+}
+
+void ConcurrentBuddyAllocator::buddy_free(ThreadCache &tc, int addr) {
+    if (addr < 0 || (addr >> min_order) >= num_blocks || (addr & ((1 << min_order) - 1)))
+        return;
+
+    int order = block_order[addr >> min_order].exchange(-1, memory_order_relaxed);
+    if (order < 0)
+        return;
+
+    int slot = order - min_order;
+
+    if (slot < CACHED_ORDERS) {
+        vector<int> &mag = tc.loaded[slot];
+        if ((int)mag.size() == MAGAZINE_SIZE)
+            flush(tc, slot);
+        mag.push_back(addr);
+        return;
+    }
+
+    give_block(order, addr);
+}
+
+void ConcurrentBuddyAllocator::drain() {
+    for (int s = 0; s < CACHED_ORDERS; s++) {
+        Depot &d = depots[s];
+        lock_guard<mutex> g(d.lock);
+        for (auto &mag : d.full)
+            release_blocks(mag, min_order + s);
+        d.full.clear();
+    }
+}
+
+int ConcurrentBuddyAllocator::get_used_memory() const {
+    return used_memory.load();
+}
+
+long long ConcurrentBuddyAllocator::get_list_locks() {
+    long long total = 0;
+    for (int o = min(min_order, max_order); o <= max_order; o++) {
+        lock_guard<mutex> g(lists[o].lock);
+        total += lists[o].locks;
+    }
+    return total;
+}
@@ -0,0 +1,157 @@
+#include "../include/events.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+const char EVENT_MAGIC[8] = {'M', 'S', 'E', 'V', 'E', 'N', 'T', '1'};
+
+Verbosity verbosity = VERBOSITY_TEXT;
+long long event_counts[EV_COUNT];
+
+static const char *event_names[EV_COUNT] = {
+    "Page hits", "Page faults", "Page evictions", "Page mappings",
+    "Invalid addresses", "L1 hits", "L2 hits", "Memory accesses",
+    "Faults with no unpinned frame", "Cache-to-cache transfers",
+    "L1 invalidations", "L3+ hits"
+};
+
+// Buffered binary event log; records are written in blocks.
+class EventLog {
+    FILE *out = nullptr;
+    vector<EventRecord> buf;
+
+public:
+    bool open(const string &path) {
+        close();
+        out = fopen(path.c_str(), "wb");
+        if (!out)
+            return false;
+        fwrite(EVENT_MAGIC, 1, sizeof(EVENT_MAGIC), out);
+        buf.reserve(1 << 16);
+        return true;
+    }
+
+    void add(const EventRecord &r) {
+        buf.push_back(r);
+        if (buf.size() == buf.capacity())
+            flush();
+    }
+
+    void flush() {
+        if (out && !buf.empty())
+            fwrite(buf.data(), sizeof(EventRecord), buf.size(), out);
+        buf.clear();
+    }
+
+    void close() {
+        flush();
+        if (out)
+            fclose(out);
+        out = nullptr;
+    }
+
+    ~EventLog() { close(); }
+};
+
+static EventLog event_log;
+
+void format_event(ostream &out, const EventRecord &r) {
+    switch (r.type) {
+        case EV_PAGE_HIT:
+            out << "PAGE HIT (PID " << r.pid << ", page " << r.a << ", frame " << r.b << ")\n";
+            break;
+        case EV_PAGE_FAULT:
+            out << "PAGE FAULT (PID " << r.pid << ", page " << r.a << ")\n";
+            break;
+        case EV_PAGE_EVICTION:
+            out << "PAGE EVICTION: PID " << r.pid << ", frame " << r.b << "\n";
+            break;
+        case EV_PAGE_MAPPED:
+            out << "Mapped (PID " << r.pid << ", page " << r.a << ") -> frame " << r.b << "\n";
+            break;
+        case EV_INVALID_VADDR:
+            out << "Invalid virtual address: " << r.a << "\n";
+            break;
+        case EV_L1_HIT:
+            out << "L1 hit!\n";
+            break;
+        case EV_L2_HIT:
+            out << "L1 miss. L2 hit.\n";
+            break;
+        case EV_MEMORY_ACCESS:
+            // b is the number of cache levels.
+            for (long long l = 1; l <= r.b; l++)
+                out << "L" << l << " miss. ";
+            out << "Accessing main memory.\n";
+            break;
+        case EV_NO_FRAME:
+            out << "No unpinned frame available for PID " << r.pid << ", page " << r.a << "\n";
+            break;
+        case EV_L1_TRANSFER:
+            out << "L1 miss. Line supplied by core " << r.b << ".\n";
+            break;
+        case EV_L1_INVALIDATE:
+            out << "Invalidated line 0x" << hex << r.a << dec << " in core " << r.b << "\n";
+            break;
+        case EV_CACHE_HIT:
+            for (long long l = 1; l < r.b; l++)
+                out << "L" << l << " miss. ";
+            out << "L" << r.b << " hit.\n";
+            break;
+        default:
+            out << "Unknown event " << r.type << "\n";
+            break;
+    }
+}
+
+void log_event(SimEvent ev, int pid, long long a, long long b) {
+    EventRecord r{(uint16_t)ev, 0, pid, a, b};
+    if (verbosity == VERBOSITY_TRACE)
+        event_log.add(r);
+    else
+        format_event(cout, r);
+}
+
+bool set_verbosity(const string &level, const string &path) {
+    Verbosity v;
+    if (level == "off")           v = VERBOSITY_OFF;
+    else if (level == "counters") v = VERBOSITY_COUNTERS;
+    else if (level == "text")     v = VERBOSITY_TEXT;
+    else if (level == "trace")    v = VERBOSITY_TRACE;
+    else {
+        cout << "Unknown verbosity level: " << level << "\n";
+        return false;
+    }
+
+    event_log.close();
+    if (v == VERBOSITY_TRACE && !event_log.open(path)) {
+        cout << "Cannot create event log: " << path << "\n";
+        return false;
+    }
+
+    verbosity = v;
+    return true;
+}
+
+const char *verbosity_name() {
+    static const char *names[] = {"off", "counters", "text", "trace"};
+    return names[verbosity];
+}
+
+void reset_event_counts() {
+    memset(event_counts, 0, sizeof(event_counts));
+}
+
+void print_event_counts() {
+    cout << "\n----- Events (" << verbosity_name() << ") -----\n";
+    for (int e = 0; e < EV_COUNT; e++) {
+        // Frameless faults only occur with pinning, coherence events only
+        // in multi-core mode, and L3+ hits with more than two cache levels.
+        if (e >= EV_NO_FRAME && event_counts[e] == 0)
+            continue;
+        cout << event_names[e] << ": " << event_counts[e] << "\n";
+    }
+}
@@ -0,0 +1,61 @@
+#include "../include/handles.h"
+
+using namespace std;
+
+HandleTable block_handles;
+
+int HandleTable::issue(int addr, Owner owner) {
+    int slot;
+    if (!spare.empty()) {
+        slot = spare.back();
+        spare.pop_back();
+        entries[slot] = {addr, owner, next_id};
+    }
+    else {
+        slot = (int)entries.size();
+        entries.push_back({addr, owner, next_id});
+    }
+
+    slot_of[next_id] = slot;
+    slot_at[addr] = slot;
+    return next_id++;
+}
+
+void HandleTable::release(int addr) {
+    auto it = slot_at.find(addr);
+    if (it == slot_at.end())
+        return;
+
+    int slot = it->second;
+    slot_of.erase(entries[slot].id);
+    spare.push_back(slot);
+    slot_at.erase(it);
+}
+
+int HandleTable::id_of(int addr) const {
+    auto it = slot_at.find(addr);
+    return (it == slot_at.end()) ? -1 : entries[it->second].id;
+}
+
+HandleTable::Status HandleTable::find(int id, int &addr, Owner &owner) const {
+    if (id < 1 || id >= next_id)
+        return UNKNOWN;
+
+    // An issued id whose slot has moved on belongs to a freed block.
+    auto it = slot_of.find(id);
+    if (it == slot_of.end())
+        return STALE;
+
+    const Entry &e = entries[it->second];
+    addr = e.addr;
+    owner = e.owner;
+    return LIVE;
+}
+
+void HandleTable::clear() {
+    entries.clear();
+    spare.clear();
+    slot_of.clear();
+    slot_at.clear();
+    next_id = 1;
+}
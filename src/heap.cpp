@@ -0,0 +1,46 @@
+#include "../include/heap.h"
+
+using namespace std;
+
+int BlockHeap::new_slot(const Block &b) {
+    if (!spare.empty()) {
+        int s = spare.back();
+        spare.pop_back();
+        slots[s] = b;
+        return s;
+    }
+    slots.push_back(b);
+    return (int)slots.size() - 1;
+}
+
+void BlockHeap::reset(int total_size) {
+    slots.clear();
+    spare.clear();
+    head = new_slot({0, total_size, true, -1, -1, -1, -1, -1});
+}
+
+int BlockHeap::split(int slot, int size) {
+    Block &b = slots[slot];
+    Block rest{b.start + size, b.size - size, true, -1, slot, b.next, -1, -1};
+    b.size = size;
+
+    int r = new_slot(rest);
+    Block &cur = slots[slot];   // new_slot may have grown the vector
+    if (cur.next != -1)
+        slots[cur.next].prev = r;
+    cur.next = r;
+    return r;
+}
+
+void BlockHeap::merge_next(int slot) {
+    Block &b = slots[slot];
+    int n = b.next;
+    Block &nb = slots[n];
+
+    b.size += nb.size;
+    b.next = nb.next;
+    if (nb.next != -1)
+        slots[nb.next].prev = slot;
+
+    spare.push_back(n);
+}
@@ -0,0 +1,204 @@
+#include "../include/hierarchy.h"
+#include "../include/events.h"
+#include <iostream>
+
+using namespace std;
+
+bool parse_inclusion(const string &name, InclusionPolicy &policy) {
+    if (name == "nine")           policy = INCLUSION_NINE;
+    else if (name == "inclusive") policy = INCLUSION_INCLUSIVE;
+    else if (name == "exclusive") policy = INCLUSION_EXCLUSIVE;
+    else return false;
+    return true;
+}
+
+const char *inclusion_name(InclusionPolicy policy) {
+    switch (policy) {
+        case INCLUSION_NINE:      return "NINE";
+        case INCLUSION_INCLUSIVE: return "inclusive";
+        case INCLUSION_EXCLUSIVE: return "exclusive";
+    }
+    return "?";
+}
+
+CacheHierarchy::CacheHierarchy(int memory_size, int memory_latency)
+    : memory_size(memory_size), memory_latency(memory_latency) {
+}
+
+void CacheHierarchy::add_level(int size, int block, int ways, ReplacementKind policy, int latency) {
+    levels.push_back({unique_ptr<Cache>(new Cache(size, block, ways, policy)), latency, nullptr});
+}
+
+void CacheHierarchy::set_profiler(int level, StackProfiler *profiler) {
+    levels[level].profiler.reset(profiler);
+}
+
+void CacheHierarchy::set_latency(int level, int cycles) {
+    if (level == (int)levels.size())
+        memory_latency = cycles;
+    else
+        levels[level].latency = cycles;
+}
+
+void CacheHierarchy::set_inclusion(InclusionPolicy policy) {
+    inclusion = policy;
+}
+
+bool CacheHierarchy::fits_inclusion(InclusionPolicy policy, int next_block) const {
+    vector<int> blocks;
+    for (auto &l : levels)
+        blocks.push_back(l.cache->get_block_size());
+    if (next_block > 0)
+        blocks.push_back(next_block);
+
+    for (size_t i = 1; i < blocks.size(); i++) {
+        if (policy == INCLUSION_EXCLUSIVE && blocks[i] != blocks[i - 1])
+            return false;
+        if (policy == INCLUSION_INCLUSIVE && blocks[i] < blocks[i - 1])
+            return false;
+    }
+    return true;
+}
+
+bool CacheHierarchy::has_prefetcher() const {
+    for (auto &l : levels)
+        if (l.cache->has_prefetcher())
+            return true;
+    return false;
+}
+
+// Drops the `bytes` at `addr` from the levels between `from` and `level`;
+// levels above `from` are the caller's, so the range is queued for it.
+void CacheHierarchy::back_invalidate(int addr, int bytes, int level, int from) {
+    for (int l = from; l < level; l++) {
+        Cache &c = *levels[l].cache;
+        for (int a = addr; a < addr + bytes; a += c.get_block_size())
+            if (c.invalidate(a))
+                back_invalidations++;
+    }
+
+    if (from > 0)
+        removed_above.push_back({addr, bytes});
+}
+
+// Puts the block in `level` and deals with its victim. `ready` is the
+// cycle a prefetched block arrives, -1 for a demand fill.
+void CacheHierarchy::place(int addr, int level, int from, long long ready) {
+    Cache &c = *levels[level].cache;
+    int victim = ready < 0 ? c.insert(addr) : c.prefetch_fill(addr, ready);
+    if (victim == -1)
+        return;
+
+    if (inclusion == INCLUSION_INCLUSIVE) {
+        back_invalidate(victim, c.get_block_size(), level, from);
+    }
+    else if (inclusion == INCLUSION_EXCLUSIVE && level + 1 < (int)levels.size() &&
+             !levels[level + 1].cache->contains(victim)) {
+        place(victim, level + 1, from, -1);
+    }
+}
+
+// Brings the block found in level `served` (memory if past the last)
+// into level `top` and, unless exclusive, the levels between them.
+void CacheHierarchy::fill(int addr, int top, int from, int served, long long ready) {
+    if (inclusion == INCLUSION_EXCLUSIVE) {
+        if (served < (int)levels.size())
+            levels[served].cache->invalidate(addr);
+        place(addr, top, from, ready);
+        return;
+    }
+
+    // Bottom up, so a back-invalidation cannot undo a fill above it.
+    for (int l = served - 1; l > top; l--)
+        place(addr, l, from, -1);
+    place(addr, top, from, ready);
+}
+
+// Exclusive only: a level above `level` already holds the block, so
+// fetching it into `level` would give it a second home.
+bool CacheHierarchy::held_above(int addr, int level, int from) const {
+    if (inclusion != INCLUSION_EXCLUSIVE)
+        return false;
+
+    for (int l = from; l < level; l++)
+        if (levels[l].cache->contains(addr))
+            return true;
+    return false;
+}
+
+// Fetches the blocks the level's prefetcher proposed from the levels
+// below it. The fetches overlap demand work, so their cycles are kept
+// apart; a demand hit on a block still in flight stalls for the rest.
+void CacheHierarchy::issue_prefetches(int level, int from) {
+    Cache &c = *levels[level].cache;
+    vector<int> &queue = c.prefetch_queue();
+    int n = (int)levels.size();
+
+    for (int addr : queue) {
+        if (addr >= memory_size || c.contains(addr) || held_above(addr, level, from))
+            continue;
+
+        long long latency = 0;
+        int served = level + 1;
+        for (; served < n; served++) {
+            latency += levels[served].latency;
+            if (levels[served].cache->contains(addr))
+                break;
+        }
+        if (served == n)
+            latency += memory_latency;
+
+        fill(addr, level, from, served, total_cycles + latency);
+        prefetch_cycles += latency;
+    }
+    queue.clear();
+}
+
+long long CacheHierarchy::access(int addr, int from) {
+    int n = (int)levels.size();
+    long long cycles = 0;
+
+    int served = from;
+    for (; served < n; served++) {
+        Level &l = levels[served];
+        cycles += l.latency;
+        if (l.profiler)
+            l.profiler->access(addr);
+        if (l.cache->lookup(addr))
+            break;
+    }
+
+    if (served == n)
+        cycles += memory_latency;
+    if (served > from)
+        fill(addr, from, from, served, -1);
+
+    if (served == n)
+        emit_event(EV_MEMORY_ACCESS, -1, addr, n);
+    else if (served == 0)
+        emit_event(EV_L1_HIT, -1, addr, -1);
+    else if (served == 1)
+        emit_event(EV_L2_HIT, -1, addr, -1);
+    else
+        emit_event(EV_CACHE_HIT, -1, addr, served + 1);
+
+    for (int l = from; l < n; l++)
+        if (levels[l].cache->has_prefetcher())
+            issue_prefetches(l, from);
+
+    return cycles;
+}
+
+void CacheHierarchy::print_stats(int from) const {
+    for (int l = from; l < (int)levels.size(); l++)
+        levels[l].cache->print_stats("L" + to_string(l + 1));
+
+    if (inclusion == INCLUSION_INCLUSIVE)
+        cout << "Inclusion: inclusive (back-invalidations " << back_invalidations << ")\n";
+    else if (inclusion == INCLUSION_EXCLUSIVE)
+        cout << "Inclusion: exclusive\n";
+
+    for (int l = from; l < (int)levels.size(); l++)
+        if (levels[l].profiler)
+            levels[l].profiler->print("L" + to_string(l + 1));
+}
@@ -1,64 +1,425 @@
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <chrono>
+#include <climits>
+#include <unordered_map>
 
 #include "../include/memory.h"
 #include "../include/buddy.h"
 #include "../include/cache.h"
+#include "../include/hierarchy.h"
+#include "../include/coherence.h"
 #include "../include/vm.h"
+#include "../include/tlb.h"
+#include "../include/page_policy.h"
+#include "../include/trace.h"
+#include "../include/events.h"
+#include "../include/sweep.h"
 
 using namespace std;
 
 BuddyAllocator* buddy = nullptr;
-Cache* L1 = nullptr;
-Cache* L2 = nullptr;
+LinearAllocator* linear = nullptr;
+CacheHierarchy* caches = nullptr;
+
+// Multi-core mode ('cores N'): private copies of the L1 share the levels
+// below it, and accesses go to the core running the current stream.
+CoherentCaches* multicore = nullptr;
+int current_core = 0;
 
 int PHYSICAL_MEM_SIZE = 0;
 int PAGE_SIZE = 0;
 int NUM_FRAMES = 0;
 
 enum AllocatorMode { NONE, LINEAR, BUDDY };
-enum LinearStrategy { LNONE, FIRST, BEST, WORST };
+enum LinearStrategy { LNONE, FIRST, BEST, WORST, TLSF };
 
 AllocatorMode alloc_mode = NONE;
 LinearStrategy lin_strategy = LNONE;
 
-bool compare_mode = false;
 bool system_initialized = false;
 
-void cache_access(int addr) {
+static void memory_access(int addr, bool write) {
     if (addr < 0) return;
 
-    if (L1->access(addr)) {
-        total_cycles += l1_penalty;
-        cout << "L1 hit!\n";
+    if (multicore)
+        total_cycles += multicore->access(current_core, addr, write);
+    else
+        total_cycles += caches->access(addr);
+}
+
+// Page-walk hook target: walks read through the current core.
+void cache_access(int addr) {
+    memory_access(addr, false);
+}
+
+// Replacement policy by name for a cache with `ways` ways; FIFO when
+// absent or unusable.
+static ReplacementKind cache_policy(const string &level, const string &name, int ways) {
+    ReplacementKind kind = REPL_FIFO;
+    if (name.empty())
+        return kind;
+
+    if (!parse_replacement(name, kind)) {
+        cout << "Unknown " << level << " replacement policy '" << name << "', using fifo\n";
+        return REPL_FIFO;
+    }
+    if (!replacement_supports(kind, ways)) {
+        cout << level << " policy " << name << " does not support "
+             << ways << "-way sets, using fifo\n";
+        return REPL_FIFO;
+    }
+    return kind;
+}
+
+// Optional replacement policy given after a cache's geometry on the same
+// input line.
+static ReplacementKind read_cache_policy(const string &level, int ways) {
+    string rest, name;
+    getline(cin, rest);
+    istringstream(rest) >> name;
+    return cache_policy(level, name, ways);
+}
+
+static const char *INCLUSION_BLOCK_RULE =
+    "inclusive: blocks never shrink going down, exclusive: one block size";
+
+// "l1", "l2", ... to a hierarchy level index, or -1.
+static int cache_level_number(const string &name) {
+    if (name.size() < 2 || name[0] != 'l' || !isdigit((unsigned char)name[1]))
+        return -1;
+
+    int l = atoi(name.c_str() + 1) - 1;
+    return l >= 0 && l < caches->get_levels() ? l : -1;
+}
+
+static void print_vm_stats() {
+    cout << "\n----- Virtual Memory -----\n";
+
+    int hits = get_page_hits();
+    int faults = get_page_faults();
+    int total = hits + faults;
+
+    cout << "Total Page Hits: " << hits << "\n";
+    cout << "Total Page Faults: " << faults << "\n";
+
+    if (total > 0)
+        cout << "Fault Rate: " << (faults * 100.0 / total) << "%\n";
+    else
+        cout << "Fault Rate: 0%\n";
+
+    // Only radix tables are walked.
+    if (get_page_walk_refs() > 0)
+        cout << "Page-walk memory refs: " << get_page_walk_refs() << "\n";
+
+    // Only writes (from 'write' or a trace) can dirty a page.
+    if (get_dirty_writebacks() > 0)
+        cout << "Dirty Write-backs: " << get_dirty_writebacks() << "\n";
+
+    cout << "\nPer-Process Frame Usage:\n";
+
+    if (!any_vm_initialized()) {
+        cout << "No virtual memory initialized for any process.\n";
+    }
+    else {
+        for (int pid : get_initialized_pids()) {
+            int used = get_used_frames(pid);
+            if (used == 0)
+                cout << "PID " << pid << ": NIL\n";
+            else
+                cout << "PID " << pid << ": "
+                     << used << "/" << get_total_frames()
+                     << " frames used\n";
+        }
+    }
+}
+
+static void print_tlb_stats() {
+    if (!tlb_enabled())
+        return;
+
+    cout << "\n----- TLB -----\n";
+    get_tlb(1)->print_stats("L1 TLB");
+    if (get_tlb(2))
+        get_tlb(2)->print_stats("L2 TLB");
+    cout << "Process switch: " << (tlb_asid_tagged() ? "ASID-tagged" : "flush") << "\n";
+    if (!tlb_asid_tagged())
+        cout << "TLB Flushes: " << get_tlb_flushes() << "\n";
+    cout << "Page Walks: " << get_page_walks() << "\n";
+    cout << "Page walk penalty: " << page_walk_penalty << "\n";
+}
+
+// tlb <entries> <ways> [policy] [asid|flush]   (level 1)
+// tlb2 <entries> <ways> [policy]               (level 2)
+// tlb off
+static void configure_tlb_command(int level) {
+    string rest, first;
+    getline(cin, rest);
+    istringstream in(rest);
+    in >> first;
+
+    if (level == 1 && first == "off") {
+        disable_tlb();
+        cout << "TLB disabled\n";
+        return;
+    }
+
+    int entries = 0, ways = 0;
+    string policy, mode;
+    istringstream(first) >> entries;
+    in >> ways >> policy >> mode;
+
+    // "tlb 64 4 flush": the policy word is optional.
+    if (policy == "asid" || policy == "flush") {
+        mode = policy;
+        policy.clear();
+    }
+
+    string name = level == 1 ? "TLB" : "L2 TLB";
+    if (entries <= 0 || ways <= 0 || entries % ways != 0) {
+        cout << "Error: " << name << " entries must be a positive multiple of the associativity.\n";
+        return;
+    }
+
+    ReplacementKind kind = REPL_LRU;
+    if (!policy.empty() && !parse_replacement(policy, kind)) {
+        cout << "Unknown " << name << " replacement policy '" << policy << "'\n";
+        return;
+    }
+    if (!replacement_supports(kind, ways)) {
+        cout << name << " policy " << replacement_name(kind) << " does not support "
+             << ways << "-way sets\n";
         return;
     }
+    if (!mode.empty() && mode != "asid" && mode != "flush") {
+        cout << "Unknown TLB process-switch mode '" << mode << "' (asid|flush)\n";
+        return;
+    }
+
+    if (!configure_tlb(level, entries, ways, kind, mode != "flush")) {
+        cout << "Error: configure the first-level TLB before the L2 TLB.\n";
+        return;
+    }
+
+    cout << name << ": " << entries << " entries, " << ways << "-way, "
+         << replacement_name(kind);
+    if (level == 1)
+        cout << ", " << (mode == "flush" ? "flush on process switch" : "ASID-tagged");
+    cout << "\n";
+}
+
+static void print_cache_stats() {
+    cout << "\n----- Cache -----\n";
+    if (multicore) {
+        multicore->print_stats();
+        caches->print_stats(1);
+    }
+    else {
+        caches->print_stats();
+    }
+    cout << "Total Memory Access Cycles: " << total_cycles << "\n";
+    if (caches->has_prefetcher())
+        cout << "Prefetch Fill Cycles (overlapped): " << caches->get_prefetch_cycles() << "\n";
+    cout << "Disk Penalty per fault: " << disk_penalty << "\n";
+
+    // With per-access text off, the event tallies stand in for it.
+    if (verbosity == VERBOSITY_COUNTERS || verbosity == VERBOSITY_TRACE)
+        print_event_counts();
+}
+
+// For OPT: next[i] is the index of the next record touching the same
+// page as record i, found in one backward pass.
+static vector<long long> trace_next_use(const TraceFile &trace) {
+    vector<long long> next(trace.size(), NEVER_USED);
+    unordered_map<PageKey, long long, PageKeyHash> seen;
 
-    total_cycles += l1_penalty;
+    for (long long i = (long long)trace.size() - 1; i >= 0; i--) {
+        const TraceRecord &r = trace.begin()[i];
+        if (r.vaddr > (uint64_t)LLONG_MAX)
+            continue;
+
+        long long page = vm_page_number((int)r.pid, (long long)r.vaddr);
+        if (page < 0)
+            continue;
 
-    if (L2->access(addr)) {
-        total_cycles += l2_penalty;
-        cout << "L1 miss. L2 hit.\n";
+        auto it = seen.find({(int)r.pid, page});
+        if (it != seen.end()) {
+            next[i] = it->second;
+            it->second = i;
+        }
+        else {
+            seen.emplace(PageKey{(int)r.pid, page}, i);
+        }
+    }
+    return next;
+}
+
+// Runs every record of the trace through the page tables and calls
+// use(record, paddr), with paddr -1 for an invalid address. In
+// multi-core mode each record's stream is first placed on its core,
+// unless `pick_cores` is off.
+template <class F>
+static void translate_trace(const TraceFile &trace, F use, bool pick_cores = true) {
+    vector<long long> next_use;
+    if (get_vm_policy() == PAGE_OPT)
+        next_use = trace_next_use(trace);
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        const TraceRecord &r = trace.begin()[i];
+
+        if (r.vaddr > (uint64_t)LLONG_MAX) {
+            use(r, -1);
+            continue;
+        }
+
+        if (!next_use.empty())
+            set_next_use(next_use[i]);
+        if (multicore && pick_cores)
+            current_core = multicore->core_of((int)r.pid, trace_thread(r));
+
+        use(r, vm_access((int)r.pid, (long long)r.vaddr, r.flags & TRACE_WRITE));
+    }
+}
+
+// Replays a binary trace through the page tables and the cache
+// hierarchy, then prints the same counters as 'stats'. The wall-clock
+// time is only printed when asked for, so replay output stays
+// reproducible.
+static void replay_trace(const string &path, bool timed) {
+    TraceFile trace;
+    if (!trace.open(path))
         return;
+
+    long long reads = 0, writes = 0, invalid = 0;
+    auto start = chrono::steady_clock::now();
+
+    translate_trace(trace, [&](const TraceRecord &r, int paddr) {
+        if (r.flags & TRACE_WRITE) writes++;
+        else reads++;
+
+        if (paddr == -1)
+            invalid++;
+        else
+            memory_access(paddr, r.flags & TRACE_WRITE);
+    });
+
+    chrono::duration<double> secs = chrono::steady_clock::now() - start;
+
+    cout << "Trace replayed: " << trace.size() << " accesses ("
+         << reads << " reads, " << writes << " writes)\n";
+    cout << "Invalid addresses: " << invalid << "\n";
+    if (timed) {
+        cout << "Replay time: " << secs.count() << " s";
+        if (secs.count() > 0)
+            cout << " (" << (long long)(trace.size() / secs.count()) << " accesses/s)";
+        cout << "\n";
     }
 
-    total_cycles += l2_penalty + memory_penalty;
-    cout << "L1 miss. L2 miss. Accessing main memory.\n";
+    print_vm_stats();
+    print_tlb_stats();
+    print_cache_stats();
+}
+
+// Physical addresses collected for a sweep, page-walk references included.
+static vector<int> *sweep_addrs = nullptr;
+
+static void sweep_walk(int addr) {
+    sweep_addrs->push_back(addr);
+}
+
+// Translates the trace once, as 'trace' would on freshly initialised
+// processes, then simulates every configuration over the resulting
+// addresses in parallel. The translation runs on scratch page tables
+// with events off, so the live VM state, counters, cycles and caches
+// are as they were before, and the results do not depend on earlier
+// accesses.
+static void sweep_trace(const string &path, const vector<SweepConfig> &configs, const string &csv) {
+    TraceFile trace;
+    if (!trace.open(path))
+        return;
+
+    vector<int> addrs;
+    addrs.reserve(trace.size());
+    long long invalid = 0;
+
+    bool walks = page_walk_hook_set();
+    sweep_addrs = &addrs;
+    if (walks)
+        set_page_walk_hook(sweep_walk);
+
+    long long cycles = total_cycles;
+    Verbosity level = verbosity;
+    verbosity = VERBOSITY_OFF;
+    begin_vm_scratch();
+
+    translate_trace(trace, [&](const TraceRecord &, int paddr) {
+        if (paddr == -1)
+            invalid++;
+        else
+            addrs.push_back(paddr);
+    }, false);
+
+    end_vm_scratch();
+    verbosity = level;
+    total_cycles = cycles;
+
+    if (walks)
+        set_page_walk_hook(cache_access);
+    sweep_addrs = nullptr;
+
+    vector<SweepResult> results = run_sweep(addrs, configs, caches->get_latency(0),
+                                            caches->get_memory_latency());
+
+    cout << "Swept " << configs.size() << " configurations over " << addrs.size()
+         << " accesses (" << invalid << " invalid)\n";
+    print_sweep(configs, results);
+
+    if (!csv.empty()) {
+        if (write_sweep_csv(csv, configs, results))
+            cout << "CSV written to " << csv << "\n";
+        else
+            cout << "Cannot write " << csv << "\n";
+    }
 }
 
 void print_help() {
     cout << "\nCOMMANDS\n";
     cout << "----------------------------------------------------------------------\n";
     cout << "init                                        Initialize system\n";
+    cout << "                                            (cache lines: <size> <block> <ways> [fifo|lru|plru|srrip|brrip|random])\n";
     cout << "alloc                                       Configure allocator\n";
     cout << "malloc <size>                               Allocate memory\n";
     cout << "free <block_id>                             Free block\n";
-    cout << "vm_init <pid> <vsize>                       Init paging\n";
-    cout << "access <pid> <vaddr>                        Access virtual address\n";
+    cout << "vm_init <pid> <vsize> [radix [levels]] [huge <bytes>]\n";
+    cout << "                                            Init paging (flat or 2-4 level radix table,\n";
+    cout << "                                            base or huge pages)\n";
+    cout << "walk_cache <on|off>                         Send radix page-walk references through the caches\n";
+    cout << "access <pid> <vaddr> [thread]               Access virtual address\n";
+    cout << "write <pid> <vaddr> [thread]                Access and mark page dirty\n";
+    cout << "cores <n>                                   Private L1 per core, shared L2, MESI\n";
+    cout << "                                            (streams = pid/thread, cores round robin)\n";
+    cout << "cache_level <size> <block> <ways> <latency> [policy]\n";
+    cout << "                                            Add a cache level below the last one\n";
+    cout << "latency <l1|l2|...|mem> <cycles>            Set a level's access latency\n";
+    cout << "inclusion <nine|inclusive|exclusive>        Inclusion policy between cache levels\n";
+    cout << "prefetch <l1|l2|...> <none|next|stride|stream> [degree] [distance]\n";
+    cout << "                                            Attach a hardware prefetcher\n";
+    cout << "stack_profile <l1|l2|...> [sets...|off]     Miss-ratio curves of the stream reaching a level\n";
+    cout << "pin <pid> <vaddr> / unpin <pid> <vaddr>     Keep a resident page from eviction\n";
     cout << "vm_table <pid>                              Print page table\n";
+    cout << "vm_policy <lru|fifo|clock|second|arc|ws [window]|opt>\n";
+    cout << "                                            Page replacement policy\n";
+    cout << "tlb <entries> <ways> [policy] [asid|flush]  Enable a TLB (tlb off to remove)\n";
+    cout << "tlb2 <entries> <ways> [policy]              Add a second-level TLB\n";
+    cout << "trace <file> [time]                         Replay a binary trace (time: print run time)\n";
+    cout << "sweep <file> <size:block:ways[:policy]>... [csv <out>]\n";
+    cout << "                                            Simulate many caches over one trace in parallel\n";
+    cout << "                                            (scratch page tables; simulator state is kept)\n";
+    cout << "verbosity <off|counters|text|trace> [file]  Per-access event output\n";
     cout << "dump                                        Dump heap\n";
     cout << "stats                                       Show statistics\n";
-    cout << "compare                                     Compare strategies\n";
+    cout << "compare [heap sizes...]                     Compare strategies (in parallel)\n";
     cout << "clear_workload                              Clear workload\n";
     cout << "help                                        Show help\n";
     cout << "exit                                        Quit\n";
@@ -81,12 +442,6 @@ int main() {
             continue;
         }
 
-        if (compare_mode &&
-            cmd != "init" && cmd != "help" && cmd != "exit") {
-            cout << "Error: Simulator must be reinitialized after compare.\n";
-            continue;
-        }
-
         if (cmd == "init") {
 
             int size, page;
@@ -108,19 +463,20 @@ int main() {
             PAGE_SIZE = page;
             NUM_FRAMES = size / page;
 
-            reset_allocation_stats();
-            init_memory(size);
             reset_vm_system(size, page);
-            buddy_ids.clear();
             workload.clear();
 
+            delete linear;
             delete buddy;
-            delete L1;
-            delete L2;
+            delete multicore;
+            delete caches;
 
-            buddy = new BuddyAllocator(size, 128);
-            L1 = nullptr;
-            L2 = nullptr;
+            block_handles.clear();
+            linear = new LinearAllocator(size, &block_handles);
+            buddy = new BuddyAllocator(size, 128, &block_handles);
+            caches = nullptr;
+            multicore = nullptr;
+            current_core = 0;
 
             cout << "System memory and page size initialize\n";
             cout << "Configure - cache :\n";
@@ -129,17 +485,21 @@ int main() {
 
             cout << "Enter L1 cache size, L1_block size, L1 associativity:\n>>";
             cin >> c1 >> b1 >> a1;
+            ReplacementKind p1 = read_cache_policy("L1", a1);
 
             cout << "Enter L2 cache size, L2_block size, L2 associativity:\n>>";
             cin >> c2 >> b2 >> a2;
+            ReplacementKind p2 = read_cache_policy("L2", a2);
 
-            L1 = new Cache(c1, b1, a1);
-            L2 = new Cache(c2, b2, a2);
+            // 1 cycle for L1, 5 for L2, 50 for memory until changed
+            // with 'latency'.
+            caches = new CacheHierarchy(size, 50);
+            caches->add_level(c1, b1, a1, p1, 1);
+            caches->add_level(c2, b2, a2, p2, 5);
 
             alloc_mode = NONE;
             lin_strategy = LNONE;
             total_cycles = 0;
-            compare_mode = false;
 
             cout << "System initialized\n";
             cout << "Physical Memory : " << size << " bytes\n";
@@ -148,21 +508,339 @@ int main() {
         }
 
         else if (cmd == "vm_init") {
-            int pid, vsize;
+            int pid;
+            long long vsize;
             cin >> pid >> vsize;
-            init_vm(pid, vsize);
+
+            // Optional "radix [levels]" and "huge <bytes>" on the same line.
+            string rest, word;
+            getline(cin, rest);
+            istringstream in(rest);
+            vector<string> opts;
+            while (in >> word)
+                opts.push_back(word);
+
+            auto number_follows = [&](size_t i) {
+                return i + 1 < opts.size() && isdigit((unsigned char)opts[i + 1][0]);
+            };
+
+            int levels = 0, huge = 0;
+            bool ok = true;
+            for (size_t i = 0; ok && i < opts.size(); i++) {
+                if (opts[i] == "radix") {
+                    levels = 4;
+                    if (number_follows(i))
+                        istringstream(opts[++i]) >> levels;
+                    if (levels < 2 || levels > 4) {
+                        cout << "Error: radix page tables have 2 to 4 levels.\n";
+                        ok = false;
+                    }
+                }
+                else if (opts[i] == "huge" && number_follows(i)) {
+                    istringstream(opts[++i]) >> huge;
+                }
+                else if (opts[i] == "huge") {
+                    cout << "Error: huge needs a page size in bytes.\n";
+                    ok = false;
+                }
+                else {
+                    cout << "Unknown vm_init option '" << opts[i] << "' (radix [levels], huge <bytes>)\n";
+                    ok = false;
+                }
+            }
+            if (ok)
+                init_vm(pid, vsize, levels, huge);
+        }
+
+        else if (cmd == "walk_cache") {
+            string state;
+            cin >> state;
+            if (state == "on")
+                set_page_walk_hook(cache_access);
+            else if (state == "off")
+                set_page_walk_hook(nullptr);
+            else {
+                cout << "Usage: walk_cache <on|off>\n";
+                continue;
+            }
+            cout << "Page-walk references " << (page_walk_hook_set() ? "go through" : "bypass")
+                 << " the L1/L2 caches\n";
         }
 
         
-        else if (cmd == "access") {
-            int pid, vaddr;
+        else if (cmd == "access" || cmd == "write") {
+            int pid;
+            long long vaddr;
             cin >> pid >> vaddr;
 
-            int paddr = vm_access(pid, vaddr);
+            // Optional thread id on the same line picks the stream's core.
+            string rest;
+            getline(cin, rest);
+            int thread = 0;
+            istringstream(rest) >> thread;
+            if (multicore)
+                current_core = multicore->core_of(pid, thread);
+
+            int paddr = vm_access(pid, vaddr, cmd == "write");
             cout << "Physical address = " << paddr << "\n";
 
             if (paddr != -1)
-                cache_access(paddr);
+                memory_access(paddr, cmd == "write");
+        }
+
+        else if (cmd == "cores") {
+            int n;
+            cin >> n;
+            if (!cin || n < 1 || n > CoherentCaches::MAX_CORES) {
+                cin.clear();
+                cout << "Usage: cores <1-" << CoherentCaches::MAX_CORES << ">\n";
+                continue;
+            }
+
+            delete multicore;
+            multicore = nullptr;
+            current_core = 0;
+            if (n > 1)
+                multicore = new CoherentCaches(n, *caches);
+
+            if (n == 1)
+                cout << "Cores: 1 (single L1)\n";
+            else
+                cout << "Cores: " << n << " (private " << caches->level(0).get_size()
+                     << "B L1s, shared L2, MESI directory)\n";
+        }
+
+        else if (cmd == "cache_level") {
+            string rest, name;
+            getline(cin, rest);
+            istringstream in(rest);
+            int size = 0, block = 0, ways = 0, latency = -1;
+            in >> size >> block >> ways >> latency >> name;
+
+            if (size <= 0 || block <= 0 || ways <= 0 || latency < 0 ||
+                size % ((long long)block * ways) != 0) {
+                cout << "Usage: cache_level <size> <block> <ways> <latency> [policy]\n";
+                continue;
+            }
+            if (!caches->fits_inclusion(caches->get_inclusion(), block)) {
+                cout << "Block size does not suit the " << inclusion_name(caches->get_inclusion())
+                     << " policy (" << INCLUSION_BLOCK_RULE << ")\n";
+                continue;
+            }
+
+            string label = "L" + to_string(caches->get_levels() + 1);
+            ReplacementKind policy = cache_policy(label, name, ways);
+            caches->add_level(size, block, ways, policy, latency);
+
+            cout << label << " cache: " << size << " bytes, " << block << "-byte blocks, "
+                 << ways << "-way, " << replacement_name(policy) << ", "
+                 << latency << " cycles\n";
+        }
+
+        else if (cmd == "latency") {
+            string level;
+            int cycles;
+            cin >> level >> cycles;
+
+            int l = level == "mem" ? caches->get_levels() : cache_level_number(level);
+            if (!cin || l == -1 || cycles < 0) {
+                cin.clear();
+                cout << "Usage: latency <l1|l2|...|mem> <cycles>\n";
+                continue;
+            }
+
+            caches->set_latency(l, cycles);
+            cout << (level == "mem" ? string("Memory") : "L" + to_string(l + 1))
+                 << " latency: " << cycles << " cycles\n";
+        }
+
+        else if (cmd == "inclusion") {
+            string name;
+            cin >> name;
+
+            InclusionPolicy policy;
+            if (!parse_inclusion(name, policy)) {
+                cout << "Usage: inclusion <nine|inclusive|exclusive>\n";
+                continue;
+            }
+            if (!caches->fits_inclusion(policy)) {
+                cout << "Block sizes do not suit the " << inclusion_name(policy)
+                     << " policy (" << INCLUSION_BLOCK_RULE << ")\n";
+                continue;
+            }
+
+            caches->set_inclusion(policy);
+            cout << "Inclusion: " << inclusion_name(policy) << "\n";
+        }
+
+        else if (cmd == "prefetch") {
+            string level, name;
+            cin >> level >> name;
+
+            // Optional degree and distance on the same line.
+            string rest;
+            getline(cin, rest);
+            istringstream in(rest);
+            int degree = 1, distance = 1;
+            in >> degree >> distance;
+
+            int l = cache_level_number(level);
+            PrefetchKind kind;
+            if (l == -1 || !parse_prefetch(name, kind) || degree < 1 || distance < 1) {
+                cout << "Usage: prefetch <l1|l2|...> <none|next|stride|stream> [degree] [distance]\n";
+                continue;
+            }
+
+            caches->level(l).set_prefetcher(kind, PAGE_SIZE, degree, distance);
+
+            string label = "L" + to_string(l + 1);
+            if (kind == PF_NONE)
+                cout << label << " prefetcher: none\n";
+            else
+                cout << label << " prefetcher: " << prefetch_name(kind)
+                     << " (degree " << degree << ", distance " << distance << ")\n";
+
+            if (l == 0 && kind != PF_NONE && multicore)
+                cout << "Note: per-core L1s in multi-core mode do not prefetch\n";
+        }
+
+        else if (cmd == "stack_profile") {
+            string level, rest, word;
+            cin >> level;
+            getline(cin, rest);
+
+            // Set counts for per-set curves; the level's own by default.
+            istringstream in(rest);
+            vector<int> set_counts;
+            bool off = false, valid = true;
+            while (in >> word) {
+                if (word == "off") {
+                    off = true;
+                    continue;
+                }
+                int sets = atoi(word.c_str());
+                if (sets < 1 || sets > 65536)
+                    valid = false;
+                set_counts.push_back(sets);
+            }
+
+            int l = cache_level_number(level);
+            if (l == -1 || !valid || (off && !set_counts.empty())) {
+                cout << "Usage: stack_profile <l1|l2|...> [sets...|off]\n";
+                continue;
+            }
+
+            string label = "L" + to_string(l + 1);
+            if (off) {
+                caches->set_profiler(l, nullptr);
+                cout << label << " stack-distance profile off\n";
+                continue;
+            }
+
+            Cache &c = caches->level(l);
+            if (set_counts.empty())
+                set_counts.push_back(c.get_num_sets());
+            caches->set_profiler(l, new StackProfiler(c.get_block_size(), set_counts));
+
+            cout << label << " stack-distance profile on (" << c.get_block_size() << "-byte blocks, sets:";
+            for (int sets : set_counts)
+                cout << " " << sets;
+            cout << ")\n";
+
+            if (l == 0 && multicore)
+                cout << "Note: per-core L1s in multi-core mode are not profiled\n";
+        }
+
+        else if (cmd == "pin" || cmd == "unpin") {
+            int pid;
+            long long vaddr;
+            cin >> pid >> vaddr;
+
+            bool ok = cmd == "pin" ? vm_pin(pid, vaddr) : vm_unpin(pid, vaddr);
+            if (ok)
+                cout << (cmd == "pin" ? "Pinned" : "Unpinned") << " PID " << pid << ", vaddr " << vaddr << "\n";
+            else if (cmd == "pin")
+                cout << "Page not resident: PID " << pid << ", vaddr " << vaddr << "\n";
+            else
+                cout << "Page not pinned: PID " << pid << ", vaddr " << vaddr << "\n";
+        }
+
+        else if (cmd == "trace") {
+            string path, rest, flag;
+            cin >> path;
+            getline(cin, rest);
+            istringstream(rest) >> flag;
+            if (!flag.empty() && flag != "time") {
+                cout << "Usage: trace <file> [time]\n";
+                continue;
+            }
+            replay_trace(path, flag == "time");
+        }
+
+        else if (cmd == "sweep") {
+            string path, rest, word, csv;
+            cin >> path;
+            getline(cin, rest);
+
+            istringstream in(rest);
+            vector<SweepConfig> configs;
+            bool ok = true;
+            while (ok && in >> word) {
+                if (word == "csv") {
+                    ok = (bool)(in >> csv);
+                    continue;
+                }
+
+                SweepConfig config;
+                string error;
+                if (!parse_sweep_config(word, config, error)) {
+                    cout << error << "\n";
+                    ok = false;
+                    break;
+                }
+                configs.push_back(config);
+            }
+
+            if (!ok || configs.empty()) {
+                cout << "Usage: sweep <file> <size:block:ways[:policy]>... [csv <out>]\n";
+                continue;
+            }
+            sweep_trace(path, configs, csv);
+        }
+
+        else if (cmd == "verbosity") {
+            string level, path;
+            cin >> level;
+            if (level == "trace")
+                cin >> path;
+            if (set_verbosity(level, path))
+                cout << "Verbosity: " << verbosity_name() << "\n";
+        }
+
+        else if (cmd == "vm_policy") {
+            string name, rest;
+            cin >> name;
+            getline(cin, rest);
+
+            // ws takes an optional window in references.
+            int window = 100, w;
+            if (istringstream(rest) >> w)
+                window = w;
+
+            if (!set_vm_policy(name, window)) {
+                cout << "Unknown page replacement policy: " << name << "\n";
+                continue;
+            }
+            cout << "Page replacement: " << vm_policy_name();
+            if (get_vm_policy() == PAGE_WORKING_SET)
+                cout << " (window " << vm_policy_window() << ")";
+            if (get_vm_policy() == PAGE_OPT)
+                cout << " (future known during trace replay only)";
+            cout << "\n";
+        }
+
+        else if (cmd == "tlb" || cmd == "tlb2") {
+            configure_tlb_command(cmd == "tlb" ? 1 : 2);
         }
 
         else if (cmd == "vm_table") {
@@ -202,12 +880,13 @@ int main() {
                 }
                 else {
                     string strat;
-                    cout << "Choose linear strategy (first_fit / best_fit / worst_fit): ";
+                    cout << "Choose linear strategy (first_fit / best_fit / worst_fit / tlsf): ";
                     cin >> strat;
 
                     if (strat == "first_fit")      lin_strategy = FIRST;
                     else if (strat == "best_fit")  lin_strategy = BEST;
                     else if (strat == "worst_fit") lin_strategy = WORST;
+                    else if (strat == "tlsf")      lin_strategy = TLSF;
                     else {
                         cout << "Invalid linear strategy.\n";
                         continue;
@@ -234,17 +913,21 @@ int main() {
                 addr = buddy->buddy_malloc(size);
             }
             else {
+                if (lin_strategy == LNONE) {
+                    cout << "No strategy selected. Run 'alloc' first.\n";
+                    continue;
+                }
+                if (size <= 0)
+                    cout << "Invalid allocation size\n";
 
                 if (lin_strategy == FIRST)
-                    addr = malloc_first_fit(size);
+                    addr = linear->malloc_first_fit(size);
                 else if (lin_strategy == BEST)
-                    addr = malloc_best_fit(size);
+                    addr = linear->malloc_best_fit(size);
                 else if (lin_strategy == WORST)
-                    addr = malloc_worst_fit(size);
-                else {
-                    cout << "No strategy selected. Run 'alloc' first.\n";
-                    continue;
-                }
+                    addr = linear->malloc_worst_fit(size);
+                else
+                    addr = linear->malloc_tlsf(size);
             }
 
             workload.push_back({ALLOC_EVENT, size});
@@ -252,9 +935,7 @@ int main() {
             if (addr == -1)
                 cout << "Allocation failed\n";
             else {
-                int id = (alloc_mode == BUDDY)
-                        ? buddy_ids[addr]
-                        : get_block_id(addr);
+                int id = block_handles.id_of(addr);
 
                 cout << "Allocated block id=" << id
                      << " at address=0x" << hex << addr << dec << "\n";
@@ -265,22 +946,24 @@ int main() {
             int id;
             cin >> id;
 
-            int addr = get_block_start_by_id(id);
+            int addr = -1;
+            HandleTable::Owner owner;
+            HandleTable::Status status = block_handles.find(id, addr, owner);
 
-            if (addr == -1) {
-                for (auto &p : buddy_ids)
-                    if (p.second == id) addr = p.first;
+            if (status == HandleTable::STALE) {
+                cout << "Block " << id << " already freed\n";
+                continue;
             }
 
-            if (addr == -1) {
+            if (status == HandleTable::UNKNOWN) {
                 cout << "No block with id=" << id << "\n";
                 continue;
             }
 
-            if (buddy_ids.count(addr))
+            if (owner == HandleTable::BUDDY)
                 buddy->buddy_free(addr);
             else
-                free_block(addr);
+                linear->free_block(addr);
 
             workload.push_back({FREE_EVENT, addr});
             cout << "Block " << id << " freed\n";
@@ -293,7 +976,7 @@ int main() {
     }
     else {
         cout << "Linear allocator in use \n";
-        dump_memory();
+        linear->dump_memory();
     }
 }
 
@@ -303,16 +986,13 @@ int main() {
             cout << "\n----- Memory -----\n";
 
             if (alloc_mode == LINEAR) {
-                cout << "Allocator Type: Linear (FF/BF/WF)\n";
+                cout << "Allocator Type: Linear (FF/BF/WF/TLSF)\n";
 
-                int internal = internal_fragmentation();
-                int external = external_fragmentation();
+                int internal = linear->internal_fragmentation();
+                int external = linear->external_fragmentation();
 
-                int total = total_memory_size;
-                int free_mem = 0;
-
-                for (auto &b : memory_blocks)
-                    if (b.free) free_mem += b.size;
+                int total = linear->get_total_size();
+                int free_mem = linear->get_free_memory();
 
                 double internal_pct = total ? (internal * 100.0 / total) : 0.0;
                 double external_pct = free_mem ? (external * 100.0 / free_mem) : 0.0;
@@ -326,16 +1006,16 @@ int main() {
                      << external_pct << "% of free memory)\n";
 
                 cout << "Memory Utilization: "
-                     << memory_utilization() << "%\n";
+                     << linear->memory_utilization() << "%\n";
 
-                allocation_stats();
+                linear->allocation_stats();
             }
 
             else if (alloc_mode == BUDDY) {
                 cout << "Allocator Type: Buddy System\n";
 
                 int used = buddy->get_used_memory();
-                int total = total_memory_size;
+                int total = PHYSICAL_MEM_SIZE;
                 int internal = buddy->get_internal_fragmentation();
                 int free_mem = total - used;
 
@@ -365,47 +1045,38 @@ int main() {
                 cout << "No allocator active\n";
             }
 
-            cout << "\n----- Virtual Memory -----\n";
-
-            int hits = get_page_hits();
-            int faults = get_page_faults();
-            int total = hits + faults;
-
-            cout << "Total Page Hits: " << hits << "\n";
-            cout << "Total Page Faults: " << faults << "\n";
-
-            if (total > 0)
-                cout << "Fault Rate: " << (faults * 100.0 / total) << "%\n";
-            else
-                cout << "Fault Rate: 0%\n";
-
-            cout << "\nPer-Process Frame Usage:\n";
+            print_vm_stats();
+            print_tlb_stats();
+            print_cache_stats();
+        }
 
-            if (!any_vm_initialized()) {
-                cout << "No virtual memory initialized for any process.\n";
-            }
-            else {
-                for (int pid : get_initialized_pids()) {
-                    int used = get_used_frames(pid);
-                    if (used == 0)
-                        cout << "PID " << pid << ": NIL\n";
-                    else
-                        cout << "PID " << pid << ": "
-                             << used << "/" << get_total_frames()
-                             << " frames used\n";
+        else if (cmd == "compare") {
+            // Optional heap sizes on the same line; the system size if none.
+            string rest;
+            getline(cin, rest);
+            istringstream in(rest);
+
+            vector<int> sizes;
+            long long heap;
+            bool ok = true;
+            while (in >> heap) {
+                if (heap < 128 || heap > (1 << 30) || (heap & (heap - 1))) {
+                    cout << "Heap sizes must be powers of two from 128 bytes to 1 GiB.\n";
+                    ok = false;
+                    break;
                 }
+                sizes.push_back((int)heap);
             }
+            if (!ok)
+                continue;
+            if (!in.eof()) {
+                cout << "Invalid heap size.\n";
+                continue;
+            }
+            if (sizes.empty())
+                sizes.push_back(PHYSICAL_MEM_SIZE);
 
-            cout << "\n----- Cache -----\n";
-            L1->print_stats("L1");
-            L2->print_stats("L2");
-            cout << "Total Memory Access Cycles: " << total_cycles << "\n";
-            cout << "Disk Penalty per fault: " << disk_penalty << "\n";
-        }
-
-        else if (cmd == "compare") {
-            compare_strategies();
-            compare_mode = true;
+            compare_strategies(workload, sizes);
         }
 
         else if (cmd == "clear_workload") {
@@ -1,50 +1,86 @@
-#include <list>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include "../include/memory.h"
 #include "../include/buddy.h"
+#include "../include/tlsf.h"
+#include "../include/fixed_buddy.h"
+#include "../include/slab.h"
 #include <sstream>
+#include <set>
+#include <map>
+#include <climits>
+#include <memory>
+#include <thread>
+#include <atomic>
 using namespace std;
 
 
-int total_alloc_requests = 0;
-int successful_allocs = 0;
-int failed_allocs = 0;
-int total_memory_size = 0;
+vector<Event> workload;
 
-int next_block_id = 1;
+LinearAllocator::LinearAllocator(int memory_size, HandleTable *handles)
+    : handles(handles) {
+    reset(memory_size);
+}
 
+void LinearAllocator::index_free(int slot) {
+    tlsf.insert(blocks, slot);
+    if (!fit_index_live)
+        return;
 
-unordered_map<int,int> buddy_ids;
-list<Block> memory_blocks;
-vector<Event> workload;
+    Block &b = blocks[slot];
+    free_by_size.insert({b.size, b.start});
+    free_by_addr[b.start] = slot;
+}
 
+void LinearAllocator::unindex_free(int slot) {
+    tlsf.remove(blocks, slot);
+    if (!fit_index_live)
+        return;
 
-void init_memory(int total_size) {
-    memory_blocks.clear();
-    total_memory_size = total_size;
-    next_block_id = 1;
+    Block &b = blocks[slot];
+    free_by_size.erase({b.size, b.start});
+    free_by_addr.erase(b.start);
+}
 
-    Block initial;
-    initial.start = 0;
-    initial.size = total_size;
-    initial.free = true;
-    initial.id = -1;
+void LinearAllocator::build_fit_index() {
+    if (fit_index_live)
+        return;
 
-    memory_blocks.push_back(initial);
+    for (int s = blocks.first(); s != -1; s = blocks[s].next) {
+        Block &b = blocks[s];
+        if (b.free) {
+            free_by_size.insert({b.size, b.start});
+            free_by_addr[b.start] = s;
+        }
+    }
+    fit_index_live = true;
+}
+
+
+void LinearAllocator::reset(int memory_size) {
+    tlsf.clear();
+    fit_index_live = false;
+    free_by_size.clear();
+    free_by_addr.clear();
+    used_by_addr.clear();
+    total_size = memory_size;
+
+    blocks.reset(memory_size);
+    index_free(blocks.first());
+    reset_allocation_stats();
 }
 
-void reset_allocation_stats() {
-   total_alloc_requests = 0;
+void LinearAllocator::reset_allocation_stats() {
+    total_alloc_requests = 0;
     successful_allocs  = 0;
     failed_allocs    = 0;
 }
 
-void dump_memory() {
+void LinearAllocator::dump_memory() const {
     cout << "----- Memory Dump -----\n";
 
-    for (auto &b : memory_blocks) {
+    for (auto &b : blocks) {
         int end = b.start + b.size - 1;
 
         cout << "[0x"
@@ -63,39 +99,52 @@ void dump_memory() {
 }
 
 
-int malloc_first_fit(int size) {
-    total_alloc_requests++;
-if (size <= 0) {
-    cout << "Invalid allocation size\n";
-    failed_allocs++;
-    return -1;
-}
+// Carves `size` bytes from the front of free block `slot`, leaving any
+// remainder as a new free block right after it. A block too small for
+// the request counts as a failed allocation.
+int LinearAllocator::place_block(int slot, int size) {
+    if (blocks[slot].size < size) {
+        failed_allocs++;
+        return -1;
+    }
 
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
+    int alloc_start = blocks[slot].start;
 
-        if (it->free && it->size >= size) {
+    unindex_free(slot);
 
-            int alloc_start = it->start;
+    if (blocks[slot].size > size)
+        index_free(blocks.split(slot, size));
 
-            if (it->size == size) {
-                it->free = false;
-                it->id = next_block_id++;
-            } else {
-                Block allocated{it->start, size, false, next_block_id++};
-                Block remaining{it->start + size,
-                                it->size - size,
-                                true,
-                                -1};
+    Block &b = blocks[slot];
+    b.free = false;
+    b.id = handles ? handles->issue(alloc_start, HandleTable::LINEAR) : -1;
+    used_by_addr[alloc_start] = slot;
 
-                it = memory_blocks.erase(it);
-                it = memory_blocks.insert(it, allocated);
-                ++it;
-                memory_blocks.insert(it, remaining);
-            }
+    successful_allocs++;
+    return alloc_start;
+}
 
-            successful_allocs++;
-            return alloc_start;
-        }
+// Counts the request; false (and a failure) for a non-positive size.
+bool LinearAllocator::check_request(int size) {
+    total_alloc_requests++;
+    if (size <= 0) {
+        failed_allocs++;
+        return false;
+    }
+    return true;
+}
+
+
+int LinearAllocator::malloc_first_fit(int size) {
+    if (!check_request(size))
+        return -1;
+
+    build_fit_index();
+
+    // Free blocks only, in address order: runs of used blocks are skipped.
+    for (auto &f : free_by_addr) {
+        if (blocks[f.second].size >= size)
+            return place_block(f.second, size);
     }
 
     failed_allocs++;
@@ -103,138 +152,111 @@ if (size <= 0) {
 }
 
 
-void free_block(int start_address) {
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
+void LinearAllocator::free_block(int start_address) {
+    auto found = used_by_addr.find(start_address);
+    if (found == used_by_addr.end())
+        return;
 
-        if (it->start == start_address && !it->free) {
+    int slot = found->second;
+    used_by_addr.erase(found);
+    if (handles)
+        handles->release(start_address);
 
-            it->free = true;
-            it->id = -1;
+    blocks[slot].free = true;
+    blocks[slot].id = -1;
 
 
-            if (it != memory_blocks.begin()) {
-                auto prev = it;
-                --prev;
-                if (prev->free) {
-                    prev->size += it->size;
-                    it = memory_blocks.erase(it);
-                    it = prev;
-                }
-            }
+    int prev = blocks[slot].prev;
+    if (prev != -1 && blocks[prev].free) {
+        unindex_free(prev);
+        blocks.merge_next(prev);
+        slot = prev;
+    }
 
 
-            auto next = it;
-            ++next;
-            if (next != memory_blocks.end() && next->free) {
-                it->size += next->size;
-                memory_blocks.erase(next);
-            }
-
-            return;
-        }
+    int next = blocks[slot].next;
+    if (next != -1 && blocks[next].free) {
+        unindex_free(next);
+        blocks.merge_next(slot);
     }
+
+    index_free(slot);
 }
 
 
-int malloc_best_fit(int size) {
-    total_alloc_requests++;
-    if (size <= 0) {
-        cout << "Invalid allocation size\n";
-        failed_allocs++;
+int LinearAllocator::malloc_best_fit(int size) {
+    if (!check_request(size))
         return -1;
-    }
 
-    auto best = memory_blocks.end();
+    build_fit_index();
 
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-        if (it->free && it->size >= size) {
-            if (best == memory_blocks.end() || it->size < best->size)
-                best = it;
-        }
-    }
+    // Smallest block that fits; ties go to the lowest address.
+    auto best = free_by_size.lower_bound({size, INT_MIN});
 
-    if (best == memory_blocks.end()) {
+    if (best == free_by_size.end()) {
         failed_allocs++;
         return -1;
     }
 
-    int alloc_start = best->start;
-
-    if (best->size == size) {
-        best->free = false;
-        best->id = next_block_id++;
-    } else {
-        Block allocated{best->start, size, false, next_block_id++};
-        Block remaining{best->start + size,
-                        best->size - size,
-                        true,
-                        -1};
-
-        best = memory_blocks.erase(best);
-        best = memory_blocks.insert(best, allocated);
-        ++best;
-        memory_blocks.insert(best, remaining);
-    }
-
-    successful_allocs++;
-    return alloc_start;
+    return place_block(free_by_addr[best->second], size);
 }
 
 
-int malloc_worst_fit(int size) {
-    total_alloc_requests++;
-if (size <= 0) {
-    cout << "Invalid allocation size\n";
-    failed_allocs++;
-    return -1;
-}
+int LinearAllocator::malloc_worst_fit(int size) {
+    if (!check_request(size))
+        return -1;
 
-    auto worst = memory_blocks.end();
+    build_fit_index();
 
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-        if (it->free && it->size >= size) {
-            if (worst == memory_blocks.end() || it->size > worst->size)
-                worst = it;
-        }
+    if (free_by_size.empty() || free_by_size.rbegin()->first < size) {
+        failed_allocs++;
+        return -1;
     }
 
-    if (worst == memory_blocks.end()) {
+    // Largest block; ties go to the lowest address.
+    auto worst = free_by_size.lower_bound({free_by_size.rbegin()->first, INT_MIN});
+
+    return place_block(free_by_addr[worst->second], size);
+}
+
+
+int LinearAllocator::malloc_tlsf(int size) {
+    if (!check_request(size))
+        return -1;
+
+    // Larger than the heap: no block can fit, whatever class it rounds to.
+    if (size > total_size) {
         failed_allocs++;
         return -1;
     }
 
-    int alloc_start = worst->start;
-
-    if (worst->size == size) {
-        worst->free = false;
-        worst->id = next_block_id++;
-    } else {
-        Block allocated{worst->start, size, false, next_block_id++};
-        Block remaining{worst->start + size,
-                        worst->size - size,
-                        true,
-                        -1};
-
-        worst = memory_blocks.erase(worst);
-        worst = memory_blocks.insert(worst, allocated);
-        ++worst;
-        memory_blocks.insert(worst, remaining);
+    int slot = tlsf.find(size);
+
+    if (slot == -1) {
+        failed_allocs++;
+        return -1;
     }
 
-    successful_allocs++;
-    return alloc_start;
+    return place_block(slot, size);
 }
 
 
-int internal_fragmentation() {
+int LinearAllocator::get_free_memory() const {
+    int free_mem = 0;
+    for (auto &b : blocks)
+        if (b.free) free_mem += b.size;
+    return free_mem;
+}
+
+int LinearAllocator::internal_fragmentation() const {
     return 0;  
 }
 
-int external_fragmentation() {
+int LinearAllocator::external_fragmentation() const {
     int total_free = 0;
     int max_free = 0;
 
-    for (auto &b : memory_blocks) {
+    for (auto &b : blocks) {
         if (b.free) {
             total_free += b.size;
             max_free = max(max_free, b.size);
@@ -244,10 +266,10 @@ int external_fragmentation() {
     return total_free - max_free;
 }
 
-double memory_utilization() {
+double LinearAllocator::memory_utilization() const {
     int used = 0, total = 0;
 
-    for (auto &b : memory_blocks) {
+    for (auto &b : blocks) {
         total += b.size;
         if (!b.free) used += b.size;
     }
@@ -255,26 +277,20 @@ double memory_utilization() {
     return total ? (used * 100.0 / total) : 0.0;
 }
 
-void allocation_stats() {
-    cout << "Allocation Requests: " << total_alloc_requests << "\n";
-    cout << "Successful Allocations: " << successful_allocs << "\n";
-    cout << "Failed Allocations: " << failed_allocs << "\n";
-
-    double rate = total_alloc_requests
+double LinearAllocator::success_rate() const {
+    return total_alloc_requests
         ? (successful_allocs * 100.0 / total_alloc_requests)
         : 0.0;
-
-    cout << "Allocation Success Rate: " << rate << "%\n";
 }
 
-
-static void reset_simulation(int mem_size) {
-    init_memory(mem_size);
-    total_alloc_requests = 0;
-    successful_allocs = 0;
-    failed_allocs = 0;
+void LinearAllocator::allocation_stats() const {
+    cout << "Allocation Requests: " << total_alloc_requests << "\n";
+    cout << "Successful Allocations: " << successful_allocs << "\n";
+    cout << "Failed Allocations: " << failed_allocs << "\n";
+    cout << "Allocation Success Rate: " << success_rate() << "%\n";
 }
 
+
 struct Result {
     int ext_frag;
     int int_frag;
@@ -282,39 +298,43 @@ struct Result {
     double success;
 };
 
-static Result replay(const string &type) {
-    reset_simulation(total_memory_size);
+enum Strategy { S_FF, S_BF, S_WF, S_TLSF, S_BUDDY, S_SLAB, STRATEGY_COUNT };
 
-    for (auto &e : workload) {
+static const char *strategy_names[STRATEGY_COUNT] = {
+    "FF", "BF", "WF", "TLSF", "Buddy", "Slab"
+};
+
+static Result replay_linear(const vector<Event> &events, Strategy type, int heap_size) {
+    LinearAllocator heap(heap_size);
+
+    for (auto &e : events) {
         if (e.type == ALLOC_EVENT) {
-            if (type == "ff") malloc_first_fit(e.value);
-            else if (type == "bf") malloc_best_fit(e.value);
-            else if (type == "wf") malloc_worst_fit(e.value);
+            if (type == S_FF) heap.malloc_first_fit(e.value);
+            else if (type == S_BF) heap.malloc_best_fit(e.value);
+            else if (type == S_WF) heap.malloc_worst_fit(e.value);
+            else if (type == S_TLSF) heap.malloc_tlsf(e.value);
         } else {
-            free_block(e.value);
+            heap.free_block(e.value);
         }
     }
 
     return {
-        external_fragmentation(),
-        internal_fragmentation(),
-        memory_utilization(),
-        total_alloc_requests
-            ? (successful_allocs * 100.0 / total_alloc_requests)
-            : 0.0
+        heap.external_fragmentation(),
+        heap.internal_fragmentation(),
+        heap.memory_utilization(),
+        heap.success_rate()
     };
 }
 
 
-static Result replay_buddy() {
-    BuddyAllocator buddy_test(total_memory_size, 128);
-
+template <class Buddy>
+static Result replay_buddy_with(const vector<Event> &events, Buddy &buddy_test, int heap_size) {
     unordered_map<int, int> alloc_req; 
     int total_allocs = 0;
     int successful = 0;
     int internal_frag = 0;
 
-    for (auto &e : workload) {
+    for (auto &e : events) {
         if (e.type == ALLOC_EVENT) {
             total_allocs++;
 
@@ -340,7 +360,7 @@ static Result replay_buddy() {
         }
     }
 
-    double util = (buddy_test.get_used_memory() * 100.0) / total_memory_size;
+    double util = (buddy_test.get_used_memory() * 100.0) / heap_size;
     double success_rate = total_allocs ? (successful * 100.0 / total_allocs) : 0.0;
 
     return {
@@ -351,17 +371,69 @@ static Result replay_buddy() {
     };
 }
 
+template <int Size>
+static Result replay_buddy_fixed(const vector<Event> &events) {
+    auto fixed = make_unique<FixedBuddyAllocator<128, Size>>();
+    return replay_buddy_with(events, *fixed, Size);
+}
 
-void compare_strategies() {
-    if (workload.empty()) {
-        cout << "No workload recorded.\n";
-        return;
+// Only a few common heap sizes get a FixedBuddyAllocator instantiation;
+// each one is a separate copy of the replay code and of the allocator's
+// arrays, so any other size replays on the runtime BuddyAllocator.
+static Result replay_buddy(const vector<Event> &events, int heap_size) {
+    switch (heap_size) {
+        case 1 << 8:  return replay_buddy_fixed<1 << 8>(events);
+        case 1 << 10: return replay_buddy_fixed<1 << 10>(events);
+        case 1 << 12: return replay_buddy_fixed<1 << 12>(events);
+        case 1 << 16: return replay_buddy_fixed<1 << 16>(events);
+    }
+
+    BuddyAllocator buddy_test(heap_size, 128);
+    return replay_buddy_with(events, buddy_test, heap_size);
+}
+
+
+static Result replay_slab(const vector<Event> &events, int heap_size) {
+    BuddyAllocator pages(heap_size, 128);
+    SlabAllocator slab(pages, 128);
+
+    int total_allocs = 0;
+    int successful = 0;
+
+    for (auto &e : events) {
+        if (e.type == ALLOC_EVENT) {
+            total_allocs++;
+            if (slab.slab_malloc(e.value) != -1)
+                successful++;
+        } else {
+            slab.slab_free(e.value);
+        }
     }
 
-    Result ff = replay("ff");
-    Result bf = replay("bf");
-    Result wf = replay("wf");
-    Result buddy = replay_buddy();
+    double util = (slab.get_used_memory() * 100.0) / heap_size;
+    double success_rate = total_allocs ? (successful * 100.0 / total_allocs) : 0.0;
+
+    return {
+        slab.get_slab_slack(),
+        slab.get_internal_fragmentation(),
+        util,
+        success_rate
+    };
+}
+
+static Result replay(const vector<Event> &events, Strategy type, int heap_size) {
+    switch (type) {
+        case S_BUDDY: return replay_buddy(events, heap_size);
+        case S_SLAB:  return replay_slab(events, heap_size);
+        default:      return replay_linear(events, type, heap_size);
+    }
+}
+
+
+static void print_table(const Result *results) {
+    ios state(nullptr);
+    state.copyfmt(cout);
+
 cout << setfill(' ');     
 cout << fixed << setprecision(2);
 
@@ -375,10 +447,6 @@ cout << left
      << "\n";
 
 auto print_row = [&](const string& name, const Result& r) {
-    ostringstream util, succ;
-    util << fixed << setprecision(2) << r.util << "%";
-    succ << fixed << setprecision(2) << r.success << "%";
-
     cout << left
      << setw(10) << name
      << setw(12) << r.int_frag
@@ -389,27 +457,43 @@ auto print_row = [&](const string& name, const Result& r) {
 
 };
 
+    for (int s = 0; s < STRATEGY_COUNT; s++)
+        print_row(strategy_names[s], results[s]);
+
+    // Later output (stats, dump) keeps its own formatting.
+    cout.copyfmt(state);
+}
 
 
+// Every (heap size, strategy) pair is an independent replay on its own
+// allocator instance, so the pairs are spread over a pool of threads
+// that pull the next job from a shared counter. Results are printed in
+// the fixed order afterwards and do not depend on the thread count.
+void compare_strategies(const vector<Event> &events, const vector<int> &heap_sizes) {
+    if (events.empty()) {
+        cout << "No workload recorded.\n";
+        return;
+    }
 
+    int jobs = (int)heap_sizes.size() * STRATEGY_COUNT;
+    vector<Result> results(jobs);
+    atomic<int> next_job(0);
 
-    print_row("FF", ff);
-    print_row("BF", bf);
-    print_row("WF", wf);
-    print_row("Buddy", buddy);
-}
+    auto worker = [&] {
+        for (int j = next_job++; j < jobs; j = next_job++)
+            results[j] = replay(events, (Strategy)(j % STRATEGY_COUNT), heap_sizes[j / STRATEGY_COUNT]);
+    };
 
-int get_block_id(int start_address) {
-    for (auto &b : memory_blocks) {
-        if (!b.free && b.start == start_address)
-            return b.id;
+    int threads = min(jobs, max(1, (int)thread::hardware_concurrency()));
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool) th.join();
+
+    for (size_t i = 0; i < heap_sizes.size(); i++) {
+        if (heap_sizes.size() > 1)
+            cout << "Heap size: " << heap_sizes[i] << " bytes\n";
+        print_table(&results[i * STRATEGY_COUNT]);
     }
-    return -1;
 }
-int get_block_start_by_id(int id) {
-    for (auto &b : memory_blocks) {
-        if (!b.free && b.id == id)
-            return b.start;
-    }
-    return -1;
-}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "../include/page_policy.h"
+#include <algorithm>
+
+using namespace std;
+
+bool parse_page_policy(const string &name, PagePolicyKind &kind) {
+    if (name == "lru")         kind = PAGE_LRU;
+    else if (name == "fifo")   kind = PAGE_FIFO;
+    else if (name == "clock")  kind = PAGE_CLOCK;
+    else if (name == "second") kind = PAGE_SECOND_CHANCE;
+    else if (name == "arc")    kind = PAGE_ARC;
+    else if (name == "ws")     kind = PAGE_WORKING_SET;
+    else if (name == "opt")    kind = PAGE_OPT;
+    else return false;
+    return true;
+}
+
+const char *page_policy_name(PagePolicyKind kind) {
+    switch (kind) {
+        case PAGE_LRU:           return "LRU";
+        case PAGE_FIFO:          return "FIFO";
+        case PAGE_CLOCK:         return "CLOCK";
+        case PAGE_SECOND_CHANCE: return "Second-chance";
+        case PAGE_ARC:           return "ARC";
+        case PAGE_WORKING_SET:   return "Working-set";
+        case PAGE_OPT:           return "OPT";
+    }
+    return "?";
+}
+
+PagePolicy::PagePolicy(PagePolicyKind kind, int num_frames, int window)
+    : kind(kind), num_frames(num_frames), window(window),
+      prev(num_frames, -1), next(num_frames, -1),
+      on_list(num_frames, 0), referenced(num_frames, 0),
+      key(num_frames, {-1, -1}), stamp(num_frames, 0) {
+}
+
+void PagePolicy::push_front(int l, int f) {
+    FrameList &L = lists[l];
+    prev[f] = -1;
+    next[f] = L.head;
+    if (L.head != -1) prev[L.head] = f;
+    else              L.tail = f;
+    L.head = f;
+    L.size++;
+    on_list[f] = (uint8_t)l;
+}
+
+void PagePolicy::unlink(int f) {
+    FrameList &L = lists[on_list[f]];
+    if (prev[f] != -1) next[prev[f]] = next[f];
+    else               L.head = next[f];
+    if (next[f] != -1) prev[next[f]] = prev[f];
+    else               L.tail = prev[f];
+    prev[f] = next[f] = -1;
+    L.size--;
+    on_list[f] = 0;
+}
+
+// Least recent usable head on list l, or -1.
+int PagePolicy::last_usable(int l, const function<bool(int)> &usable) const {
+    for (int f = lists[l].tail; f != -1; f = prev[f])
+        if (usable(f))
+            return f;
+    return -1;
+}
+
+void PagePolicy::forget_ghost(const PageKey &k) {
+    auto it = ghost_of.find(k);
+    if (it == ghost_of.end())
+        return;
+    ghosts[it->second.first].erase(it->second.second);
+    ghost_of.erase(it);
+}
+
+// ARC bounds: |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c.
+void PagePolicy::trim_ghosts() {
+    while (!ghosts[1].empty() && lists[1].size + (int)ghosts[1].size() > num_frames)
+        forget_ghost(ghosts[1].back());
+    while (!ghosts[2].empty() &&
+           lists[1].size + lists[2].size + (int)(ghosts[1].size() + ghosts[2].size()) > 2 * num_frames)
+        forget_ghost(ghosts[2].back());
+}
+
+void PagePolicy::on_fault(int pid, long long page) {
+    if (kind != PAGE_ARC)
+        return;
+
+    ghost_hit = 0;
+    auto it = ghost_of.find({pid, page});
+    if (it == ghost_of.end())
+        return;
+
+    int b1 = (int)ghosts[1].size(), b2 = (int)ghosts[2].size();
+    ghost_hit = it->second.first;
+    if (ghost_hit == 1)
+        target_t1 = min(num_frames, target_t1 + max(b2 / b1, 1));
+    else
+        target_t1 = max(0, target_t1 - max(b1 / b2, 1));
+}
+
+void PagePolicy::on_map(int head, int pid, long long page, long long next_use) {
+    key[head] = {pid, page};
+    referenced[head] = 1;
+
+    switch (kind) {
+        case PAGE_ARC:
+            // A page remembered in a ghost list has been used twice.
+            if (ghost_hit) {
+                forget_ghost({pid, page});
+                push_front(2, head);
+            }
+            else {
+                push_front(1, head);
+            }
+            ghost_hit = 0;
+            trim_ghosts();
+            break;
+
+        case PAGE_WORKING_SET:
+            stamp[head] = ++proc_time[pid];
+            push_front(1, head);
+            break;
+
+        case PAGE_OPT:
+            stamp[head] = next_use;
+            by_next_use.insert({next_use, head});
+            push_front(1, head);
+            break;
+
+        default:
+            push_front(1, head);
+            break;
+    }
+}
+
+void PagePolicy::on_hit(int head, long long next_use) {
+    referenced[head] = 1;
+
+    switch (kind) {
+        case PAGE_LRU:
+            if (lists[1].head != head) {
+                unlink(head);
+                push_front(1, head);
+            }
+            break;
+
+        case PAGE_ARC:
+            unlink(head);
+            push_front(2, head);
+            break;
+
+        case PAGE_WORKING_SET:
+            stamp[head] = ++proc_time[key[head].pid];
+            unlink(head);
+            push_front(1, head);
+            break;
+
+        case PAGE_OPT:
+            by_next_use.erase({stamp[head], head});
+            stamp[head] = next_use;
+            by_next_use.insert({next_use, head});
+            break;
+
+        default:
+            break;
+    }
+}
+
+void PagePolicy::on_unmap(int head, bool evicted) {
+    if (kind == PAGE_ARC && evicted) {
+        int l = on_list[head];
+        ghosts[l].push_front(key[head]);
+        ghost_of[key[head]] = {l, ghosts[l].begin()};
+    }
+    if (kind == PAGE_OPT)
+        by_next_use.erase({stamp[head], head});
+
+    unlink(head);
+    referenced[head] = 0;
+    key[head] = {-1, -1};
+
+    if (kind == PAGE_ARC)
+        trim_ghosts();
+}
+
+int PagePolicy::victim(const function<bool(int)> &usable) {
+    switch (kind) {
+        case PAGE_LRU:
+        case PAGE_FIFO:
+            return last_usable(1, usable);
+
+        case PAGE_CLOCK:
+            // Two sweeps: the first may only clear referenced bits.
+            for (int step = 0; step < 2 * num_frames; step++) {
+                int f = hand;
+                hand = (hand + 1) % num_frames;
+
+                if (!on_list[f] || !usable(f))
+                    continue;
+                if (referenced[f]) {
+                    referenced[f] = 0;
+                    continue;
+                }
+                return f;
+            }
+            return -1;
+
+        case PAGE_SECOND_CHANCE:
+            for (int step = 0; step < 2 * lists[1].size; step++) {
+                int f = lists[1].tail;
+                if (usable(f) && !referenced[f])
+                    return f;
+                referenced[f] = 0;
+                unlink(f);
+                push_front(1, f);
+            }
+            return -1;
+
+        case PAGE_ARC: {
+            int t1 = lists[1].size;
+            bool from_t1 = t1 > 0 && (t1 > target_t1 || (ghost_hit == 2 && t1 == target_t1));
+            int f = last_usable(from_t1 ? 1 : 2, usable);
+            return f != -1 ? f : last_usable(from_t1 ? 2 : 1, usable);
+        }
+
+        case PAGE_WORKING_SET:
+            for (int f = lists[1].tail; f != -1; f = prev[f]) {
+                if (proc_time[key[f].pid] - stamp[f] >= window && usable(f))
+                    return f;
+            }
+            return last_usable(1, usable);
+
+        case PAGE_OPT:
+            for (auto it = by_next_use.rbegin(); it != by_next_use.rend(); ++it)
+                if (usable(it->second))
+                    return it->second;
+            return -1;
+    }
+    return -1;
+}
@@ -0,0 +1,127 @@
+#include "../include/prefetch.h"
+#include <cstdlib>
+
+using namespace std;
+
+bool parse_prefetch(const string &name, PrefetchKind &kind) {
+    if (name == "none")        kind = PF_NONE;
+    else if (name == "next")   kind = PF_NEXT_LINE;
+    else if (name == "stride") kind = PF_STRIDE;
+    else if (name == "stream") kind = PF_STREAM;
+    else return false;
+    return true;
+}
+
+const char *prefetch_name(PrefetchKind kind) {
+    switch (kind) {
+        case PF_NONE:      return "none";
+        case PF_NEXT_LINE: return "next-line";
+        case PF_STRIDE:    return "stride";
+        case PF_STREAM:    return "stream";
+    }
+    return "?";
+}
+
+Prefetcher::Prefetcher(PrefetchKind kind, int block_size, int page_size, int degree, int distance)
+    : kind(kind), block_size(block_size), page_size(page_size),
+      degree(degree), distance(distance) {
+    if (kind == PF_STRIDE)
+        strides.resize(STRIDE_ENTRIES);
+    if (kind == PF_STREAM)
+        streams.resize(STREAMS);
+}
+
+// Blocks block + step * (distance + i) for i < degree, within addr's page.
+void Prefetcher::propose(int block, int step, int addr, vector<int> &out) const {
+    long long page = addr / page_size;
+
+    for (int i = 0; i < degree; i++) {
+        long long target = (long long)(block + (long long)step * (distance + i)) * block_size;
+        if (target < 0 || target / page_size != page)
+            break;
+        out.push_back((int)target);
+    }
+}
+
+void Prefetcher::on_access(int addr, bool trigger, vector<int> &out) {
+    int block = addr / block_size;
+
+    switch (kind) {
+        case PF_NONE:
+            break;
+
+        case PF_NEXT_LINE:
+            if (trigger)
+                propose(block, 1, addr, out);
+            break;
+
+        case PF_STRIDE: {
+            int page = addr / page_size;
+            StrideEntry &e = strides[page % STRIDE_ENTRIES];
+
+            if (e.page != page) {
+                e = StrideEntry();
+                e.page = page;
+                e.last_block = block;
+                break;
+            }
+
+            int stride = block - e.last_block;
+            if (stride == 0)
+                break;
+
+            if (stride == e.stride) {
+                if (e.confidence < 3)
+                    e.confidence++;
+            }
+            else {
+                e.stride = stride;
+                e.confidence = 0;
+            }
+            e.last_block = block;
+
+            if (e.confidence >= 2)
+                propose(block, e.stride, addr, out);
+            break;
+        }
+
+        case PF_STREAM: {
+            if (!trigger)
+                break;
+            tick++;
+
+            Stream *s = nullptr;
+            for (auto &t : streams) {
+                if (t.last_block != -1 && abs(block - t.last_block) <= STREAM_WINDOW) {
+                    s = &t;
+                    break;
+                }
+            }
+
+            if (!s) {
+                // Least recently used tracker starts a new stream.
+                s = &streams[0];
+                for (auto &t : streams)
+                    if (t.used < s->used)
+                        s = &t;
+                *s = Stream();
+                s->last_block = block;
+                s->used = tick;
+                break;
+            }
+
+            s->used = tick;
+            if (block == s->last_block)
+                break;
+
+            int dir = block > s->last_block ? 1 : -1;
+            s->confirmed = s->direction == dir;
+            s->direction = dir;
+            s->last_block = block;
+
+            if (s->confirmed)
+                propose(block, dir, addr, out);
+            break;
+        }
+    }
+}
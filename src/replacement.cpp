@@ -0,0 +1,169 @@
+#include "../include/replacement.h"
+
+using namespace std;
+
+bool parse_replacement(const string &name, ReplacementKind &kind) {
+    if (name == "fifo")        kind = REPL_FIFO;
+    else if (name == "lru")    kind = REPL_LRU;
+    else if (name == "plru")   kind = REPL_PLRU;
+    else if (name == "srrip")  kind = REPL_SRRIP;
+    else if (name == "brrip")  kind = REPL_BRRIP;
+    else if (name == "random") kind = REPL_RANDOM;
+    else return false;
+    return true;
+}
+
+const char *replacement_name(ReplacementKind kind) {
+    switch (kind) {
+        case REPL_FIFO:   return "FIFO";
+        case REPL_LRU:    return "LRU";
+        case REPL_PLRU:   return "Tree-PLRU";
+        case REPL_SRRIP:  return "SRRIP";
+        case REPL_BRRIP:  return "BRRIP";
+        case REPL_RANDOM: return "Random";
+    }
+    return "?";
+}
+
+bool replacement_supports(ReplacementKind kind, int ways) {
+    if (ways < 1)
+        return false;
+
+    switch (kind) {
+        case REPL_FIFO:
+        case REPL_RANDOM:
+            return true;
+        case REPL_PLRU:
+            return ways <= 64 && (ways & (ways - 1)) == 0;
+        case REPL_LRU:
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+            return ways <= 64;
+    }
+    return false;
+}
+
+ReplacementState::ReplacementState(ReplacementKind kind, int num_sets, int ways)
+    : kind(kind), ways(ways) {
+
+    switch (kind) {
+        case REPL_FIFO:
+            fifo_next.assign(num_sets, 0);
+            break;
+        case REPL_LRU:
+            meta.resize((size_t)num_sets * ways);
+            for (size_t i = 0; i < meta.size(); i++)
+                meta[i] = (uint8_t)(ways - 1 - i % ways);
+            break;
+        case REPL_PLRU:
+            plru_bits.assign(num_sets, 0);
+            break;
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+            meta.assign((size_t)num_sets * ways, RRPV_MAX);
+            break;
+        case REPL_RANDOM:
+            break;
+    }
+}
+
+void ReplacementState::on_hit(int set, int way) {
+    switch (kind) {
+        case REPL_FIFO:
+        case REPL_RANDOM:
+            break;
+
+        case REPL_LRU: {
+            uint8_t *m = set_meta(set);
+            uint8_t old = m[way];
+            for (int w = 0; w < ways; w++)
+                if (m[w] < old) m[w]++;
+            m[way] = 0;
+            break;
+        }
+
+        case REPL_PLRU: {
+            // Walk root to leaf, pointing every node away from `way`.
+            uint64_t &bits = plru_bits[set];
+            int node = 0;
+            for (int span = ways / 2; span >= 1; span /= 2) {
+                bool right = way & span;
+                if (right) bits &= ~((uint64_t)1 << node);
+                else       bits |= (uint64_t)1 << node;
+                node = 2 * node + 1 + right;
+            }
+            break;
+        }
+
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+            set_meta(set)[way] = 0;
+            break;
+    }
+}
+
+void ReplacementState::on_fill(int set, int way) {
+    switch (kind) {
+        case REPL_FIFO:
+            if (way == fifo_next[set])
+                fifo_next[set] = (way + 1) % ways;
+            break;
+
+        case REPL_SRRIP:
+            set_meta(set)[way] = RRPV_MAX - 1;
+            break;
+
+        case REPL_BRRIP:
+            // Long re-reference on one fill in 32, distant otherwise.
+            set_meta(set)[way] = (++fills % 32 == 0) ? RRPV_MAX - 1 : RRPV_MAX;
+            break;
+
+        default:
+            on_hit(set, way);
+            break;
+    }
+}
+
+int ReplacementState::victim(int set) {
+    switch (kind) {
+        case REPL_FIFO:
+            return fifo_next[set];
+
+        case REPL_LRU: {
+            uint8_t *m = set_meta(set);
+            for (int w = 0; w < ways; w++)
+                if (m[w] == ways - 1) return w;
+            return 0;
+        }
+
+        case REPL_PLRU: {
+            // Follow the tree bits: set means the victim is to the right.
+            uint64_t bits = plru_bits[set];
+            int node = 0, way = 0;
+            for (int span = ways / 2; span >= 1; span /= 2) {
+                bool right = (bits >> node) & 1;
+                if (right) way += span;
+                node = 2 * node + 1 + right;
+            }
+            return way;
+        }
+
+        case REPL_SRRIP:
+        case REPL_BRRIP: {
+            uint8_t *m = set_meta(set);
+            while (true) {
+                for (int w = 0; w < ways; w++)
+                    if (m[w] == RRPV_MAX) return w;
+                for (int w = 0; w < ways; w++)
+                    m[w]++;
+            }
+        }
+
+        case REPL_RANDOM:
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            return rng % ways;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "../include/slab.h"
+
+using namespace std;
+
+SlabAllocator::SlabAllocator(BuddyAllocator &backing, int page_size)
+    : pages(backing), page_size(page_size) {
+
+    // 8, 16, 24, 32, 48, 64, 96, ... up to half a page.
+    for (int base = 8; base <= page_size / 2; base *= 2) {
+        class_size.push_back(base);
+        int mid = base + base / 2;
+        if (base >= 16 && mid <= page_size / 2)
+            class_size.push_back(mid);
+    }
+
+    partial.assign(class_size.size(), -1);
+    empty_slab.assign(class_size.size(), -1);
+}
+
+int SlabAllocator::class_of(int size) const {
+    for (int c = 0; c < (int)class_size.size(); c++)
+        if (size <= class_size[c])
+            return c;
+    return -1;
+}
+
+void SlabAllocator::link_partial(int s) {
+    Slab &sl = slabs[s];
+    sl.prev = -1;
+    sl.next = partial[sl.cls];
+    if (sl.next != -1)
+        slabs[sl.next].prev = s;
+    partial[sl.cls] = s;
+}
+
+void SlabAllocator::unlink_partial(int s) {
+    Slab &sl = slabs[s];
+    if (sl.prev != -1) slabs[sl.prev].next = sl.next;
+    else               partial[sl.cls] = sl.next;
+    if (sl.next != -1) slabs[sl.next].prev = sl.prev;
+}
+
+int SlabAllocator::new_slab(int cls) {
+    int base = pages.buddy_malloc(page_size);
+    if (base == -1)
+        return -1;
+
+    int s;
+    if (!spare_slabs.empty()) {
+        s = spare_slabs.back();
+        spare_slabs.pop_back();
+    } else {
+        slabs.emplace_back();
+        s = (int)slabs.size() - 1;
+    }
+
+    Slab &sl = slabs[s];
+    int count = page_size / class_size[cls];
+    sl.base = base;
+    sl.cls = cls;
+    sl.in_use = 0;
+    sl.free_head = 0;
+    sl.link.resize(count);
+    for (int i = 0; i < count; i++)
+        sl.link[i] = (i + 1 < count) ? i + 1 : -1;
+
+    slab_at[base] = s;
+    held_pages++;
+    return s;
+}
+
+void SlabAllocator::release_slab(int s) {
+    slab_at.erase(slabs[s].base);
+    pages.buddy_free(slabs[s].base);
+    held_pages--;
+    spare_slabs.push_back(s);
+}
+
+int SlabAllocator::slab_malloc(int size) {
+    if (size <= 0)
+        return -1;
+
+    int cls = class_of(size);
+
+    if (cls == -1) {
+        int addr = pages.buddy_malloc(size);
+        if (addr == -1)
+            return -1;
+        requested[addr] = size;
+        large_block_bytes += 1 << pages.get_order(addr);
+        live_requested_bytes += size;
+        return addr;
+    }
+
+    int s = partial[cls];
+    if (s == -1) {
+        s = empty_slab[cls];
+        if (s != -1)
+            empty_slab[cls] = -1;
+        else
+            s = new_slab(cls);
+        if (s == -1)
+            return -1;
+        link_partial(s);
+    }
+
+    Slab &sl = slabs[s];
+    int obj = sl.free_head;
+    sl.free_head = sl.link[obj];
+    sl.link[obj] = ALLOCATED;
+    sl.in_use++;
+
+    if (sl.free_head == -1)
+        unlink_partial(s);
+
+    int addr = sl.base + obj * class_size[cls];
+    requested[addr] = size;
+    live_object_bytes += class_size[cls];
+    live_requested_bytes += size;
+    return addr;
+}
+
+void SlabAllocator::slab_free(int addr) {
+    auto req = requested.find(addr);
+    if (req == requested.end())
+        return;
+
+    int size = req->second;
+    requested.erase(req);
+    live_requested_bytes -= size;
+
+    auto found = slab_at.find(addr & ~(page_size - 1));
+    if (found == slab_at.end()) {
+        large_block_bytes -= 1 << pages.get_order(addr);
+        pages.buddy_free(addr);
+        return;
+    }
+
+    int s = found->second;
+    Slab &sl = slabs[s];
+    int obj = (addr - sl.base) / class_size[sl.cls];
+
+    bool was_full = (sl.free_head == -1);
+    sl.link[obj] = sl.free_head;
+    sl.free_head = obj;
+    sl.in_use--;
+    live_object_bytes -= class_size[sl.cls];
+
+    if (was_full)
+        link_partial(s);
+
+    // Keep one empty slab per class to absorb alloc/free churn.
+    if (sl.in_use == 0) {
+        unlink_partial(s);
+        if (empty_slab[sl.cls] == -1)
+            empty_slab[sl.cls] = s;
+        else
+            release_slab(s);
+    }
+}
+
+int SlabAllocator::get_internal_fragmentation() const {
+    return live_object_bytes + large_block_bytes - live_requested_bytes;
+}
+
+int SlabAllocator::get_slab_slack() const {
+    return held_pages * page_size - live_object_bytes;
+}
+
+int SlabAllocator::get_used_memory() const {
+    return held_pages * page_size + large_block_bytes;
+}
@@ -0,0 +1,149 @@
+#include "../include/stack_distance.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+static const int MIN_SLOTS = 64;
+
+StackDistance::StackDistance() : tree(MIN_SLOTS + 1, 0), owner(MIN_SLOTS, -1) {
+}
+
+void StackDistance::add(int t, int delta) {
+    for (int i = t + 1; i < (int)tree.size(); i += i & -i)
+        tree[i] += delta;
+}
+
+int StackDistance::marks_through(int t) const {
+    int sum = 0;
+    for (int i = t + 1; i > 0; i -= i & -i)
+        sum += tree[i];
+    return sum;
+}
+
+// Moves the k live marks to times 0..k-1, keeping their order, in a tree
+// with at least as many free slots again.
+void StackDistance::renumber() {
+    int k = 0;
+    for (int t = 0; t < now; t++) {
+        if (owner[t] != -1) {
+            owner[k] = owner[t];
+            last[owner[k]] = k;
+            k++;
+        }
+    }
+
+    int slots = MIN_SLOTS;
+    while (slots < 2 * k)
+        slots *= 2;
+    owner.resize(slots);
+    fill(owner.begin() + k, owner.end(), -1);
+
+    // Linear-time build: times 0..k-1 marked.
+    tree.assign(slots + 1, 0);
+    for (int i = 1; i <= k; i++)
+        tree[i] = 1;
+    for (int i = 1; i <= slots; i++) {
+        int parent = i + (i & -i);
+        if (parent <= slots)
+            tree[parent] += tree[i];
+    }
+    now = k;
+}
+
+void StackDistance::access(int block) {
+    accesses++;
+    if (block >= (int)last.size())
+        last.resize(max((size_t)block + 1, last.size() * 2), -1);
+    if (now == (int)owner.size())
+        renumber();
+
+    int &t = last[block];
+    if (t == -1) {
+        cold++;
+        live++;
+    }
+    else {
+        // Every block has one mark; those after its previous time are
+        // the distinct blocks touched since.
+        size_t d = live - marks_through(t);
+        if (d >= histogram.size())
+            histogram.resize(d + 1, 0);
+        histogram[d]++;
+
+        add(t, -1);
+        owner[t] = -1;
+    }
+
+    t = now;
+    owner[now] = block;
+    add(now, 1);
+    now++;
+}
+
+long long StackDistance::misses(long long blocks) const {
+    long long m = cold;
+    for (long long d = blocks; d < (long long)histogram.size(); d++)
+        m += histogram[d];
+    return m;
+}
+
+StackProfiler::StackProfiler(int block_size, const vector<int> &set_counts)
+    : block_size(block_size) {
+    for (int sets : set_counts)
+        per_set.push_back({BlockMapping{block_size, sets}, vector<StackDistance>(sets)});
+}
+
+void StackProfiler::access(int address) {
+    int block = address / block_size;
+    full.access(block);
+
+    for (auto &c : per_set)
+        c.sets[c.mapping.set(block)].access(c.mapping.tag(block));
+}
+
+static void print_row(long long size, long long units, long long misses, long long accesses) {
+    cout << setw(12) << size << setw(10) << units << setw(12) << misses;
+    if (accesses > 0)
+        cout << (misses * 100.0 / accesses) << "%";
+    cout << "\n";
+}
+
+void StackProfiler::print(const string &name) const {
+    ios state(nullptr);
+    state.copyfmt(cout);
+    long long accesses = full.get_accesses();
+
+    cout << name << " Stack Distance Profile (" << block_size << "-byte blocks): "
+         << accesses << " accesses, " << full.distinct_blocks() << " distinct blocks\n";
+
+    // Powers of two up to the first size left with cold misses only.
+    cout << left << "Fully associative LRU:\n"
+         << setw(12) << "Size(B)" << setw(10) << "Blocks" << setw(12) << "Misses" << "MissRatio\n";
+    for (long long blocks = 1;; blocks *= 2) {
+        print_row(blocks * block_size, blocks, full.misses(blocks), accesses);
+        if (blocks >= full.reach())
+            break;
+    }
+
+    for (auto &c : per_set) {
+        long long reach = 1;
+        for (auto &s : c.sets)
+            reach = max(reach, s.reach());
+
+        cout << "Set-associative LRU, " << c.mapping.num_sets
+             << (c.mapping.num_sets == 1 ? " set:\n" : " sets:\n")
+             << setw(12) << "Size(B)" << setw(10) << "Ways" << setw(12) << "Misses" << "MissRatio\n";
+        for (long long ways = 1;; ways *= 2) {
+            long long misses = 0;
+            for (auto &s : c.sets)
+                misses += s.misses(ways);
+
+            print_row(ways * c.mapping.num_sets * block_size, ways, misses, accesses);
+            if (ways >= reach)
+                break;
+        }
+    }
+    cout.copyfmt(state);
+}
@@ -0,0 +1,141 @@
+#include "../include/sweep.h"
+#include "../include/cache.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+
+bool parse_sweep_config(const string &text, SweepConfig &config, string &error) {
+    vector<string> parts;
+    string part;
+    istringstream in(text);
+    while (getline(in, part, ':'))
+        parts.push_back(part);
+
+    if (parts.size() < 3 || parts.size() > 4) {
+        error = "Configuration '" + text + "' is not <size>:<block>:<ways>[:policy]";
+        return false;
+    }
+
+    long long size = atoll(parts[0].c_str());
+    long long block = atoll(parts[1].c_str());
+    long long ways = atoll(parts[2].c_str());
+    if (size <= 0 || block <= 0 || ways <= 0 || size > INT32_MAX ||
+        size % (block * ways) != 0) {
+        error = "Configuration '" + text + "': size must be a positive multiple of block * ways";
+        return false;
+    }
+
+    ReplacementKind policy = REPL_FIFO;
+    if (parts.size() == 4 && !parse_replacement(parts[3], policy)) {
+        error = "Configuration '" + text + "': unknown replacement policy";
+        return false;
+    }
+    if (!replacement_supports(policy, (int)ways)) {
+        error = "Configuration '" + text + "': policy does not support " + parts[2] + "-way sets";
+        return false;
+    }
+
+    config = {(int)size, (int)block, (int)ways, policy};
+    return true;
+}
+
+string sweep_config_name(const SweepConfig &config) {
+    return to_string(config.size) + ":" + to_string(config.block) + ":" +
+           to_string(config.ways) + ":" + replacement_name(config.policy);
+}
+
+static SweepResult simulate(const vector<int> &addrs, const SweepConfig &config,
+                            int hit_latency, int miss_latency) {
+    auto start = chrono::steady_clock::now();
+    Cache cache(config.size, config.block, config.ways, config.policy);
+
+    for (int addr : addrs)
+        cache.access(addr);
+
+    SweepResult r;
+    r.accesses = cache.get_accesses();
+    r.hits = cache.get_hits();
+    r.misses = cache.get_misses();
+    r.cycles = r.accesses * hit_latency + r.misses * miss_latency;
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+// Configurations are independent, so a pool of threads pulls the next one
+// from a shared counter, as compare does with its replays. Results keep
+// the order of `configs` whatever the thread count.
+vector<SweepResult> run_sweep(const vector<int> &addrs, const vector<SweepConfig> &configs,
+                              int hit_latency, int miss_latency, int threads) {
+    int jobs = (int)configs.size();
+    vector<SweepResult> results(jobs);
+    atomic<int> next_job(0);
+
+    auto worker = [&] {
+        for (int j = next_job++; j < jobs; j = next_job++)
+            results[j] = simulate(addrs, configs[j], hit_latency, miss_latency);
+    };
+
+    if (threads <= 0)
+        threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(jobs, threads));
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool) th.join();
+
+    return results;
+}
+
+// Timings vary from run to run, so they only go to the CSV.
+void print_sweep(const vector<SweepConfig> &configs, const vector<SweepResult> &results) {
+    ios state(nullptr);
+    state.copyfmt(cout);
+
+    cout << left
+         << setw(24) << "Config"
+         << setw(12) << "Accesses"
+         << setw(12) << "Hits"
+         << setw(12) << "Misses"
+         << setw(11) << "HitRatio"
+         << "Cycles\n";
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        const SweepResult &r = results[i];
+        double ratio = r.accesses ? r.hits * 100.0 / r.accesses : 0;
+
+        cout << setw(24) << sweep_config_name(configs[i])
+             << setw(12) << r.accesses
+             << setw(12) << r.hits
+             << setw(12) << r.misses
+             << setw(11) << ((ostringstream() << fixed << setprecision(2) << ratio << "%").str())
+             << r.cycles << "\n";
+    }
+    cout.copyfmt(state);
+}
+
+bool write_sweep_csv(const string &path, const vector<SweepConfig> &configs,
+                     const vector<SweepResult> &results) {
+    ofstream out(path);
+    if (!out)
+        return false;
+
+    out << "size,block,ways,policy,accesses,hits,misses,hit_ratio,cycles,seconds\n";
+    for (size_t i = 0; i < configs.size(); i++) {
+        const SweepConfig &c = configs[i];
+        const SweepResult &r = results[i];
+        out << c.size << "," << c.block << "," << c.ways << "," << replacement_name(c.policy) << ","
+            << r.accesses << "," << r.hits << "," << r.misses << ","
+            << (r.accesses ? (double)r.hits / r.accesses : 0) << ","
+            << r.cycles << "," << r.seconds << "\n";
+    }
+    return (bool)out;
+}
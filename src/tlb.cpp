@@ -0,0 +1,85 @@
+#include "../include/tlb.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+int tlb_penalty       = 1;
+int tlb2_penalty      = 5;
+int page_walk_penalty = 30;
+
+Tlb::Tlb(int entries, int N, ReplacementKind policy)
+    : entries(entries), associativity(N), num_sets(entries / N),
+      vpns(entries, INVALID_VPN), asids(entries, -1), frames(entries, -1),
+      repl(policy, num_sets, N) {
+}
+
+int Tlb::find_way(int set_index, int asid, long long vpn) const {
+    size_t base = (size_t)set_index * associativity;
+    for (int i = 0; i < associativity; i++) {
+        if (vpns[base + i] == vpn && asids[base + i] == asid)
+            return i;
+    }
+    return -1;
+}
+
+bool Tlb::lookup(int asid, long long vpn, int &frame) {
+    accesses++;
+
+    int set_index = set_of(vpn);
+    int way = find_way(set_index, asid, vpn);
+
+    if (way != -1) {
+        hits++;
+        repl.on_hit(set_index, way);
+        frame = frames[(size_t)set_index * associativity + way];
+        return true;
+    }
+
+    misses++;
+    return false;
+}
+
+void Tlb::insert(int asid, long long vpn, int frame) {
+    int set_index = set_of(vpn);
+    size_t base = (size_t)set_index * associativity;
+
+    int way = find_way(set_index, asid, vpn);
+    if (way == -1) {
+        for (int i = 0; i < associativity; i++) {
+            if (vpns[base + i] == INVALID_VPN) {
+                way = i;
+                break;
+            }
+        }
+    }
+    if (way == -1)
+        way = repl.victim(set_index);
+
+    vpns[base + way] = vpn;
+    asids[base + way] = asid;
+    frames[base + way] = frame;
+    repl.on_fill(set_index, way);
+}
+
+void Tlb::invalidate(int asid, long long vpn) {
+    int set_index = set_of(vpn);
+    int way = find_way(set_index, asid, vpn);
+    if (way != -1)
+        vpns[(size_t)set_index * associativity + way] = INVALID_VPN;
+}
+
+void Tlb::flush() {
+    fill(vpns.begin(), vpns.end(), INVALID_VPN);
+}
+
+void Tlb::print_stats(const string &name) const {
+    cout << name << " Entries: " << entries << " (" << associativity << "-way, "
+         << replacement_name(repl.get_kind()) << ")\n";
+    cout << name << " Accesses: " << accesses << "\n";
+    cout << name << " Hits: " << hits << "\n";
+    cout << name << " Misses: " << misses << "\n";
+    if (accesses > 0)
+        cout << name << " Hit Ratio: "
+             << (hits * 100.0 / accesses) << "%\n";
+}
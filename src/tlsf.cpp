@@ -0,0 +1,96 @@
+#include "../include/tlsf.h"
+
+using namespace std;
+
+static int msb(unsigned x) {
+    return 31 - __builtin_clz(x);
+}
+
+TlsfIndex::TlsfIndex() {
+    clear();
+}
+
+void TlsfIndex::clear() {
+    fl_bitmap = 0;
+    for (int f = 0; f < FL_COUNT; f++) {
+        sl_bitmap[f] = 0;
+        for (int s = 0; s < SL_COUNT; s++)
+            heads[f][s] = -1;
+    }
+}
+
+void TlsfIndex::mapping_insert(unsigned size, int &fl, int &sl) {
+    if (size < SL_COUNT) {
+        fl = 0;
+        sl = size;
+        return;
+    }
+
+    int m = msb(size);
+    fl = m - SL_LOG2 + 1;
+    sl = (size >> (m - SL_LOG2)) - SL_COUNT;
+}
+
+// Rounds the request up to the next class boundary, so any block found
+// in the resulting class is large enough. Unsigned, so rounding a size
+// near INT_MAX cannot overflow; it lands in fl >= FL_COUNT instead.
+void TlsfIndex::mapping_search(unsigned size, int &fl, int &sl) {
+    if (size >= SL_COUNT)
+        size += (1u << (msb(size) - SL_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+}
+
+void TlsfIndex::insert(BlockHeap &heap, int slot) {
+    int fl, sl;
+    mapping_insert(heap[slot].size, fl, sl);
+
+    Block &b = heap[slot];
+    b.free_prev = -1;
+    b.free_next = heads[fl][sl];
+    if (b.free_next != -1)
+        heap[b.free_next].free_prev = slot;
+    heads[fl][sl] = slot;
+
+    fl_bitmap |= 1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+void TlsfIndex::remove(BlockHeap &heap, int slot) {
+    int fl, sl;
+    mapping_insert(heap[slot].size, fl, sl);
+
+    Block &b = heap[slot];
+    if (b.free_prev != -1)
+        heap[b.free_prev].free_next = b.free_next;
+    else
+        heads[fl][sl] = b.free_next;
+    if (b.free_next != -1)
+        heap[b.free_next].free_prev = b.free_prev;
+
+    if (heads[fl][sl] == -1) {
+        sl_bitmap[fl] &= ~(1u << sl);
+        if (!sl_bitmap[fl])
+            fl_bitmap &= ~(1u << fl);
+    }
+}
+
+int TlsfIndex::find(int size) const {
+    if (size <= 0)
+        return -1;
+
+    int fl, sl;
+    mapping_search((unsigned)size, fl, sl);
+    if (fl >= FL_COUNT || sl < 0 || sl >= SL_COUNT)
+        return -1;
+
+    unsigned sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        unsigned fl_map = (fl + 1 < 32) ? (fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (!fl_map)
+            return -1;
+        fl = __builtin_ctz(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+
+    return heads[fl][__builtin_ctz(sl_map)];
+}
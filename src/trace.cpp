@@ -0,0 +1,103 @@
+#include "../include/trace.h"
+#include <iostream>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const char TRACE_MAGIC[8] = {'M', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+TraceFile::~TraceFile() {
+    close();
+}
+
+void TraceFile::close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (map_handle) CloseHandle(map_handle);
+    if (file_handle) CloseHandle(file_handle);
+    map_handle = file_handle = nullptr;
+#else
+    if (base) munmap(base, length);
+#endif
+    base = nullptr;
+    records = nullptr;
+    length = 0;
+    count = 0;
+}
+
+bool TraceFile::open(const string &path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) {
+        cout << "Cannot open trace file: " << path << "\n";
+        return false;
+    }
+    file_handle = f;
+
+    LARGE_INTEGER sz;
+    GetFileSizeEx(f, &sz);
+    length = (size_t)sz.QuadPart;
+    if (length < sizeof(TraceHeader)) {
+        cout << "Not a trace file: " << path << "\n";
+        close();
+        return false;
+    }
+
+    map_handle = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    base = map_handle ? MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!base) {
+        cout << "Cannot map trace file: " << path << "\n";
+        close();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cout << "Cannot open trace file: " << path << "\n";
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        cout << "Not a trace file: " << path << "\n";
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)st.st_size;
+
+    void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        cout << "Cannot map trace file: " << path << "\n";
+        length = 0;
+        return false;
+    }
+    base = p;
+    madvise(base, length, MADV_SEQUENTIAL);
+#endif
+
+    const TraceHeader *h = (const TraceHeader *)base;
+    size_t available = (length - sizeof(TraceHeader)) / sizeof(TraceRecord);
+
+    if (memcmp(h->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || h->count > available) {
+        cout << "Not a trace file: " << path << "\n";
+        close();
+        return false;
+    }
+
+    records = (const TraceRecord *)((const char *)base + sizeof(TraceHeader));
+    count = (size_t)h->count;
+    return true;
+}
@@ -1,6 +1,13 @@
 #include "../include/vm.h"
+#include "../include/events.h"
+#include "../include/tlb.h"
+#include "../include/page_policy.h"
 #include <iostream>
 #include <unordered_map>
+#include <set>
+#include <functional>
+#include <memory>
+#include <climits>
 
 using namespace std;
 
@@ -8,147 +15,621 @@ static int PAGE_SIZE;
 static int NUM_FRAMES;
 static int PHYSICAL_MEM_SIZE;
 
+// Radix page-table nodes. Node addresses are synthetic physical
+// addresses above RAM, used only when walks are fed to the caches.
+struct RadixNode {
+    int addr;
+    vector<int> child;              // next-level node index, -1 if absent
+};
+
+struct RadixLeaf {
+    int addr;
+    vector<PageTableEntry> pte;
+};
+
 struct ProcessVM {
-    int num_pages;
+    long long num_pages;
+    int page_bytes;     // PAGE_SIZE, or the huge page size
+    int page_frames;    // frames per page (1 for base pages)
+    int resident;       // frames mapped by the table
+
+    // Flat mode (levels == 0): one entry per virtual page.
     vector<PageTableEntry> table;
+
+    // Radix mode: levels - 1 inner levels, inner[0] is the root.
+    int levels;
+    int level_bits;
+    vector<RadixNode> inner;
+    vector<RadixLeaf> leaves;
+};
+
+static const int PTE_BYTES = 8;
+static const long long MAX_VIRTUAL_SIZE = 1LL << 48;
+static const long long MAX_FLAT_PAGES = 1LL << 24;
+static const int MAX_LEVEL_BITS = 20;
+
+// Core map: one entry per physical frame with the reverse mapping to the
+// owning (pid, page). A huge page covers an aligned run of frames; its
+// first frame (the head) carries the mapping's state and every frame in
+// the run points back to it. Recency and referenced bits belong to the
+// replacement policy, which tracks heads. Pinned mappings are never
+// evicted.
+struct FrameEntry {
+    int pid;            // -1 if free
+    long long page;
+    bool dirty;
+    int pin_count;
+    int head;           // first frame of the mapping, -1 if free
+    int span;           // frames in the mapping (on the head)
 };
 
-static unordered_map<int, ProcessVM> page_tables;
+static const FrameEntry FREE_FRAME = {-1, -1, false, 0, -1, 0};
+
+static PagePolicyKind policy_kind = PAGE_LRU;
+static int policy_window = 0;
+static bool tlb_asid = true;       // false: flush on pid switch
+static void (*walk_hook)(int) = nullptr;
 
-static vector<int> frame_owner;   
+// Everything translation changes lives here, so a sweep can set the
+// whole state aside in one move and translate on a fresh one.
+// Configuration (sizes, policy, TLB tagging, the walk hook) stays
+// outside and is shared.
+struct VmState {
+    unordered_map<int, ProcessVM> page_tables;
+    vector<FrameEntry> frames;
 
-static int time_counter = 0;
-static int page_hits = 0;
-static int page_faults = 0;
+    // Unused frames, lowest index first.
+    set<int> free_frames;
+
+    PagePolicy replacer{PAGE_LRU, 0};
+
+    // OPT: next-use index of the access being served, if known.
+    long long pending_next_use = NEVER_USED;
+
+    // Optional TLBs in front of the page tables; off until 'tlb' is given.
+    unique_ptr<Tlb> l1_tlb;
+    unique_ptr<Tlb> l2_tlb;
+    int tlb_pid = -1;           // last pid translated
+    long long page_walks = 0;
+    long long tlb_flushes = 0;
+
+    int time_counter = 0;
+    int page_hits = 0;
+    int page_faults = 0;
+    int dirty_writebacks = 0;
+
+    long long page_walk_refs = 0;
+    long long next_table_addr = 0;
+};
+
+static VmState vm_state;
 
 int disk_penalty = 200;
 
+// Empty frames and policy for the current memory geometry.
+static void init_frames(VmState &s) {
+    s.frames.assign(NUM_FRAMES, FREE_FRAME);
+    s.replacer = PagePolicy(policy_kind, NUM_FRAMES, policy_window);
+
+    s.free_frames.clear();
+    for (int f = 0; f < NUM_FRAMES; f++)
+        s.free_frames.insert(s.free_frames.end(), f);
+
+    s.next_table_addr = PHYSICAL_MEM_SIZE;
+}
+
 void reset_vm_system(int physical_size, int page_size) {
     PHYSICAL_MEM_SIZE = physical_size;
     PAGE_SIZE = page_size;
     NUM_FRAMES = PHYSICAL_MEM_SIZE / PAGE_SIZE;
 
-    frame_owner.assign(NUM_FRAMES, -1);
-    page_tables.clear();
+    // A fresh state also drops the TLBs: their geometry made no sense
+    // for the new page size, so they are configured again.
+    vm_state = VmState();
+    init_frames(vm_state);
+    reset_event_counts();
+}
 
-    page_hits = 0;
-    page_faults = 0;
 
+static void tlb_shootdown(int pid, long long page) {
+    if (vm_state.l1_tlb) vm_state.l1_tlb->invalidate(pid, page);
+    if (vm_state.l2_tlb) vm_state.l2_tlb->invalidate(pid, page);
 }
 
+// Table memory is placed after RAM, wrapping within 1 GB, or earlier
+// where RAM ends less than 1 GB below INT_MAX, so the addresses stay
+// valid int cache inputs. With no room above RAM at all a node gets -1,
+// and walks through it are counted but not sent to the cache.
+static int table_addr(int bytes) {
+    long long end = min((long long)PHYSICAL_MEM_SIZE + (1LL << 30), (long long)INT_MAX + 1);
+    if (vm_state.next_table_addr + bytes > end)
+        vm_state.next_table_addr = PHYSICAL_MEM_SIZE;
+    if (vm_state.next_table_addr + bytes > end)
+        return -1;
 
-void init_vm(int pid, int virtual_size) {
+    int addr = (int)vm_state.next_table_addr;
+    vm_state.next_table_addr += bytes;
+    return addr;
+}
 
-    int num_pages = virtual_size / PAGE_SIZE;
+static int new_inner(ProcessVM &vm) {
+    int fanout = 1 << vm.level_bits;
+    vm.inner.push_back({table_addr(fanout * PTE_BYTES), vector<int>(fanout, -1)});
+    return (int)vm.inner.size() - 1;
+}
 
-    ProcessVM vm;
-    vm.num_pages = num_pages;
-    vm.table.assign(num_pages, {false, -1, 0});
+static int new_leaf(ProcessVM &vm) {
+    int fanout = 1 << vm.level_bits;
+    vm.leaves.push_back({table_addr(fanout * PTE_BYTES),
+                         vector<PageTableEntry>(fanout, {false, -1, 0})});
+    return (int)vm.leaves.size() - 1;
+}
+
+static void walk_ref(int node_addr, int idx) {
+    vm_state.page_walk_refs++;
+    if (walk_hook && node_addr >= 0)
+        walk_hook(node_addr + idx * PTE_BYTES);
+}
+
+// Entry for a page inside the process's range. Radix tables allocate
+// missing nodes when 'create' is set (else return nullptr), and with
+// 'walk' count one memory reference per level visited.
+static PageTableEntry *find_pte(ProcessVM &vm, long long page, bool create, bool walk) {
+    if (vm.levels == 0)
+        return &vm.table[page];
+
+    int mask = (1 << vm.level_bits) - 1;
+    int node = 0;
+
+    for (int l = 0; l < vm.levels; l++) {
+        int idx = (int)(page >> (vm.level_bits * (vm.levels - 1 - l))) & mask;
+
+        if (l == vm.levels - 1) {
+            if (walk) walk_ref(vm.leaves[node].addr, idx);
+            return &vm.leaves[node].pte[idx];
+        }
+
+        if (walk) walk_ref(vm.inner[node].addr, idx);
 
-    page_tables[pid] = vm;
+        int child = vm.inner[node].child[idx];
+        if (child == -1) {
+            if (!create)
+                return nullptr;
+            child = l == vm.levels - 2 ? new_leaf(vm) : new_inner(vm);
+            vm.inner[node].child[idx] = child;
+        }
+        node = child;
+    }
+    return nullptr;
+}
+
+// Drops the mapping whose head frame is 'head' and frees its frames.
+static void unmap(int head, bool evicted) {
+    FrameEntry &fr = vm_state.frames[head];
+    ProcessVM &proc = vm_state.page_tables[fr.pid];
+
+    PageTableEntry *pte = find_pte(proc, fr.page, false, false);
+    pte->valid = false;
+    pte->frame = -1;
+    proc.resident -= fr.span;
 
-    cout << "Virtual memory initialized for PID " << pid << " of size: " << virtual_size <<"B\n";
+    tlb_shootdown(fr.pid, fr.page);
+    vm_state.replacer.on_unmap(head, evicted);
+
+    int span = fr.span;
+    for (int f = head; f < head + span; f++) {
+        vm_state.frames[f] = FREE_FRAME;
+        vm_state.free_frames.insert(f);
+    }
 }
 
+// Eviction: reported, and dirty pages are written back first.
+static void evict(int head) {
+    FrameEntry &fr = vm_state.frames[head];
+
+    emit_event(EV_PAGE_EVICTION, fr.pid, fr.page, head);
+
+    if (fr.dirty) {
+        extern long long total_cycles;
+        vm_state.dirty_writebacks++;
+        total_cycles += disk_penalty;
+    }
 
+    unmap(head, true);
+}
 
+static void release_all_frames(ProcessVM &vm) {
+    for (auto &pte : vm.table)
+        if (pte.valid)
+            unmap(pte.frame, false);
+    for (auto &leaf : vm.leaves)
+        for (auto &pte : leaf.pte)
+            if (pte.valid)
+                unmap(pte.frame, false);
+}
 
-static int choose_victim_frame() {
-    int oldest = 1e9;
-    int victim = 0;
 
-    for (int f = 0; f < NUM_FRAMES; f++) {
+void init_vm(int pid, long long virtual_size, int radix_levels, int huge_page_size) {
 
-        if (frame_owner[f] == -1)
-            return f;
+    int page_bytes = huge_page_size > 0 ? huge_page_size : PAGE_SIZE;
+    long long num_pages = virtual_size / page_bytes;
 
-        int owner_pid = frame_owner[f];
-        auto &proc = page_tables[owner_pid];
+    if (virtual_size <= 0 || virtual_size > MAX_VIRTUAL_SIZE) {
+        cout << "Error: Virtual size must be between 1 and 2^48 bytes.\n";
+        return;
+    }
+    if (huge_page_size > 0) {
+        int span = huge_page_size / PAGE_SIZE;
+        if (huge_page_size % PAGE_SIZE != 0 || span < 2 || (span & (span - 1)) != 0) {
+            cout << "Error: Huge page size must be a power-of-two multiple (at least 2x) of the page size.\n";
+            return;
+        }
+        if (span > NUM_FRAMES) {
+            cout << "Error: Huge page size exceeds physical memory.\n";
+            return;
+        }
+    }
+    if (radix_levels == 0 && num_pages > MAX_FLAT_PAGES) {
+        cout << "Error: " << num_pages << " pages is too large for a flat page table; use radix.\n";
+        return;
+    }
 
-        for (auto &pte : proc.table) {
-            if (pte.valid && pte.frame == f && pte.last_used < oldest) {
-                oldest = pte.last_used;
-                victim = f;
-            }
+    // Radix: split the page-number bits evenly across the levels.
+    int level_bits = 0;
+    if (radix_levels > 0) {
+        int vpn_bits = 1;
+        while (vpn_bits < 62 && (1LL << vpn_bits) < num_pages)
+            vpn_bits++;
+        level_bits = (vpn_bits + radix_levels - 1) / radix_levels;
+        if (level_bits > MAX_LEVEL_BITS) {
+            cout << "Error: " << radix_levels << " levels give " << (1 << level_bits)
+                 << "-entry nodes; use more levels.\n";
+            return;
         }
     }
-    return victim;
+
+    // Re-initialising a process drops its old mappings.
+    auto old = vm_state.page_tables.find(pid);
+    if (old != vm_state.page_tables.end())
+        release_all_frames(old->second);
+
+    ProcessVM vm;
+    vm.num_pages = num_pages;
+    vm.page_bytes = page_bytes;
+    vm.page_frames = page_bytes / PAGE_SIZE;
+    vm.resident = 0;
+    vm.levels = radix_levels;
+    vm.level_bits = level_bits;
+
+    if (radix_levels == 0)
+        vm.table.assign(num_pages, {false, -1, 0});
+    else
+        new_inner(vm);
+
+    vm_state.page_tables[pid] = std::move(vm);
+
+    cout << "Virtual memory initialized for PID " << pid << " of size: " << virtual_size <<"B";
+    if (radix_levels > 0)
+        cout << " (" << radix_levels << "-level radix table)";
+    if (huge_page_size > 0)
+        cout << " (" << huge_page_size << "B huge pages)";
+    cout << "\n";
 }
 
+bool set_vm_policy(const string &name, int window) {
+    PagePolicyKind kind;
+    if (!parse_page_policy(name, kind))
+        return false;
 
-int vm_access(int pid, int vaddr) {
+    policy_kind = kind;
+    policy_window = window;
 
-    time_counter++;
+    // Resident pages join the new policy in frame order.
+    vm_state.replacer = PagePolicy(policy_kind, NUM_FRAMES, policy_window);
+    for (int f = 0; f < NUM_FRAMES; f++)
+        if (vm_state.frames[f].head == f)
+            vm_state.replacer.on_map(f, vm_state.frames[f].pid, vm_state.frames[f].page);
+    return true;
+}
 
-    int page = vaddr / PAGE_SIZE;
-    int offset = vaddr % PAGE_SIZE;
+PagePolicyKind get_vm_policy() {
+    return policy_kind;
+}
+
+const char *vm_policy_name() {
+    return page_policy_name(policy_kind);
+}
 
-    auto &proc = page_tables[pid];
+int vm_policy_window() {
+    return policy_window;
+}
 
-    if (page < 0 || page >= proc.num_pages) {
-        cout << "Invalid virtual address: " << vaddr << "\n";
+void set_next_use(long long next_use) {
+    vm_state.pending_next_use = next_use;
+}
+
+long long vm_page_number(int pid, long long vaddr) {
+    auto it = vm_state.page_tables.find(pid);
+    if (it == vm_state.page_tables.end() || it->second.page_bytes == 0 || vaddr < 0)
         return -1;
+
+    long long page = vaddr / it->second.page_bytes;
+    return page < it->second.num_pages ? page : -1;
+}
+
+bool configure_tlb(int level, int entries, int ways, ReplacementKind policy, bool asid) {
+    if (level == 2 && !vm_state.l1_tlb)
+        return false;
+
+    if (level == 2) {
+        vm_state.l2_tlb.reset(new Tlb(entries, ways, policy));
+        return true;
+    }
+
+    disable_tlb();
+    vm_state.l1_tlb.reset(new Tlb(entries, ways, policy));
+    tlb_asid = asid;
+    return true;
+}
+
+void disable_tlb() {
+    vm_state.l1_tlb.reset();
+    vm_state.l2_tlb.reset();
+    vm_state.tlb_pid = -1;
+    vm_state.page_walks = 0;
+    vm_state.tlb_flushes = 0;
+}
+
+bool tlb_enabled() { return vm_state.l1_tlb != nullptr; }
+bool tlb_asid_tagged() { return tlb_asid; }
+const Tlb *get_tlb(int level) { return level == 1 ? vm_state.l1_tlb.get() : vm_state.l2_tlb.get(); }
+long long get_page_walks() { return vm_state.page_walks; }
+long long get_tlb_flushes() { return vm_state.tlb_flushes; }
+
+// Charges the TLB lookups for (pid, page); true on a hit in either
+// level. A miss in both costs a page walk. Entries are shot down when
+// their page loses its frame, so a hit always names a resident page.
+static bool tlb_translate(int pid, long long page) {
+    extern long long total_cycles;
+
+    if (!tlb_asid && pid != vm_state.tlb_pid) {
+        if (vm_state.tlb_pid != -1) {
+            vm_state.l1_tlb->flush();
+            if (vm_state.l2_tlb) vm_state.l2_tlb->flush();
+            vm_state.tlb_flushes++;
+        }
+        vm_state.tlb_pid = pid;
     }
 
-    PageTableEntry &pte = proc.table[page];
+    int frame;
+    total_cycles += tlb_penalty;
+    if (vm_state.l1_tlb->lookup(pid, page, frame))
+        return true;
 
+    if (vm_state.l2_tlb) {
+        total_cycles += tlb2_penalty;
+        if (vm_state.l2_tlb->lookup(pid, page, frame)) {
+            vm_state.l1_tlb->insert(pid, page, frame);
+            return true;
+        }
+    }
 
-    if (pte.valid) {
-        page_hits++;
-        pte.last_used = time_counter;
-        cout << "PAGE HIT (PID " << pid
-         << ", page " << page
-         << ", frame " << pte.frame << ")\n";
-        return pte.frame * PAGE_SIZE + offset;
+    vm_state.page_walks++;
+    total_cycles += page_walk_penalty;
+    return false;
+}
+
+static void tlb_fill(int pid, long long page, int frame) {
+    vm_state.l1_tlb->insert(pid, page, frame);
+    if (vm_state.l2_tlb) vm_state.l2_tlb->insert(pid, page, frame);
+}
+
+
+// Lowest aligned run of 'span' free frames, or -1.
+static int find_free_run(int span) {
+    if (span == 1)
+        return vm_state.free_frames.empty() ? -1 : *vm_state.free_frames.begin();
+
+    auto it = vm_state.free_frames.begin();
+    while (it != vm_state.free_frames.end()) {
+        int run = (*it + span - 1) / span * span;
+        if (run + span > NUM_FRAMES)
+            break;
+
+        int k = 0;
+        while (k < span && vm_state.frames[run + k].head == -1)
+            k++;
+        if (k == span)
+            return run;
+
+        it = vm_state.free_frames.upper_bound(run + k);
     }
+    return -1;
+}
 
-    page_faults++;
-    cout << "PAGE FAULT (PID " << pid << ", page " << page << ")\n";
+// True if nothing in the aligned run belongs to a pinned mapping.
+static bool run_evictable(int run, int span) {
+    for (int f = run; f < run + span; f++) {
+        int head = vm_state.frames[f].head;
+        if (head != -1 && vm_state.frames[head].pin_count > 0)
+            return false;
+    }
+    return true;
+}
 
-    extern int total_cycles;
-    total_cycles += disk_penalty;
+// First frame of an aligned run of 'span' frames to map: free frames
+// (lowest first) if possible, else the run around the policy's victim,
+// skipping runs with pinned pages. -1 if there is none. Nothing is
+// evicted here.
+static int choose_victim_run(int span) {
+    int run = find_free_run(span);
+    if (run != -1)
+        return run;
+
+    int head = vm_state.replacer.victim([span](int f) {
+        int r = f - f % span;
+        return r + span <= NUM_FRAMES && run_evictable(r, span);
+    });
+    return head == -1 ? -1 : head - head % span;
+}
 
-    int frame = choose_victim_frame();
 
-    if (frame_owner[frame] != -1) {
-        int old_pid = frame_owner[frame];
+int vm_access(int pid, long long vaddr, bool write) {
 
-        auto &old_proc = page_tables[old_pid];
+    vm_state.time_counter++;
 
-        for (auto &old_pte : old_proc.table) {
-            if (old_pte.valid && old_pte.frame == frame) {
+    long long next_use = vm_state.pending_next_use;
+    vm_state.pending_next_use = NEVER_USED;
 
-                cout << "PAGE EVICTION: PID "
-                    << old_pid << ", frame " << frame << "\n";
+    auto &proc = vm_state.page_tables[pid];
 
-                old_pte.valid = false;
-                old_pte.frame = -1;
-                break;
-            }
-        }
+    // An unknown pid gets an empty table: every address is invalid.
+    if (proc.page_bytes == 0 || vaddr < 0 || vaddr / proc.page_bytes >= proc.num_pages) {
+        emit_event(EV_INVALID_VADDR, pid, vaddr, -1);
+        return -1;
+    }
+
+    long long page = vaddr / proc.page_bytes;
+    int offset = (int)(vaddr % proc.page_bytes);
+
+    bool tlb_hit = vm_state.l1_tlb && tlb_translate(pid, page);
+
+    // Without a TLB hit the table is walked; nodes appear on first touch.
+    PageTableEntry &pte = *find_pte(proc, page, true, !tlb_hit);
+
+    if (pte.valid) {
+        vm_state.page_hits++;
+        pte.last_used = vm_state.time_counter;
+        vm_state.replacer.on_hit(pte.frame, next_use);
+        if (write)
+            vm_state.frames[pte.frame].dirty = true;
+        if (vm_state.l1_tlb && !tlb_hit)
+            tlb_fill(pid, page, pte.frame);
+        emit_event(EV_PAGE_HIT, pid, page, pte.frame);
+        return pte.frame * PAGE_SIZE + offset;
+    }
+
+    int span = proc.page_frames;
+    vm_state.replacer.on_fault(pid, page);
+    int frame = choose_victim_run(span);
+    if (frame == -1) {
+        emit_event(EV_NO_FRAME, pid, page, -1);
+        return -1;
+    }
+
+    vm_state.page_faults++;
+    emit_event(EV_PAGE_FAULT, pid, page, -1);
 
+    extern long long total_cycles;
+    total_cycles += disk_penalty;
+
+    // Evict whatever occupies the run; a larger huge page covering it
+    // goes as a whole.
+    for (int f = frame; f < frame + span; f++) {
+        if (vm_state.frames[f].head != -1)
+            evict(vm_state.frames[f].head);
     }
 
+    for (int f = frame; f < frame + span; f++) {
+        vm_state.free_frames.erase(f);
+        vm_state.frames[f] = FREE_FRAME;
+        vm_state.frames[f].pid = pid;
+        vm_state.frames[f].page = page;
+        vm_state.frames[f].head = frame;
+    }
 
-    frame_owner[frame] = pid;
+    FrameEntry &fr = vm_state.frames[frame];
+    fr.span = span;
+    fr.dirty = write;
+    vm_state.replacer.on_map(frame, pid, page, next_use);
+    proc.resident += span;
     pte.valid = true;
     pte.frame = frame;
-    pte.last_used = time_counter;
-cout << "Mapped (PID " << pid
-     << ", page " << page
-     << ") -> frame " << frame << "\n";
+    pte.last_used = vm_state.time_counter;
+    emit_event(EV_PAGE_MAPPED, pid, page, frame);
+    if (vm_state.l1_tlb)
+        tlb_fill(pid, page, frame);
     return frame * PAGE_SIZE + offset;
 }
 
 
 
+// Radix tables print only mapped pages, one row per run of consecutive
+// pages in consecutive frames.
+static void dump_radix_table(int pid, ProcessVM &proc) {
+    cout << "PID " << pid << " Page Table (" << proc.levels << "-level radix, "
+         << proc.inner.size() + proc.leaves.size() << " nodes";
+    if (proc.page_frames > 1)
+        cout << ", " << proc.page_bytes << "B pages";
+    cout << ")\n";
+    cout << "Pages\tFrames\n";
+
+    int span = proc.page_frames;
+    long long run_page = -1, run_len = 0;
+    int run_frame = -1;
+
+    auto flush_run = [&]() {
+        if (run_len == 0)
+            return;
+        if (run_len == 1 && span == 1)
+            cout << run_page << "\t" << run_frame << "\n";
+        else if (run_len == 1)
+            cout << run_page << "\t" << run_frame << "-" << run_frame + span - 1 << "\n";
+        else
+            cout << run_page << "-" << run_page + run_len - 1 << "\t"
+                 << run_frame << "-" << run_frame + run_len * span - 1 << "\n";
+        run_len = 0;
+    };
+
+    // Depth-first in index order visits pages in ascending order.
+    function<void(int, int, long long)> visit = [&](int node, int level, long long prefix) {
+        int fanout = 1 << proc.level_bits;
+
+        if (level == proc.levels - 1) {
+            auto &leaf = proc.leaves[node];
+            for (int i = 0; i < fanout; i++) {
+                if (!leaf.pte[i].valid)
+                    continue;
+                long long page = (prefix << proc.level_bits) | i;
+                int frame = leaf.pte[i].frame;
+                if (run_len > 0 && page == run_page + run_len && frame == run_frame + run_len * span) {
+                    run_len++;
+                    continue;
+                }
+                flush_run();
+                run_page = page;
+                run_frame = frame;
+                run_len = 1;
+            }
+            return;
+        }
+
+        for (int i = 0; i < fanout; i++) {
+            int child = proc.inner[node].child[i];
+            if (child != -1)
+                visit(child, level + 1, (prefix << proc.level_bits) | i);
+        }
+    };
+
+    visit(0, 0, 0);
+    flush_run();
+}
+
 void dump_page_table(int pid) {
-    auto &proc = page_tables[pid];
+    auto &proc = vm_state.page_tables[pid];
+
+    if (proc.levels > 0) {
+        dump_radix_table(pid, proc);
+        return;
+    }
 
-    cout << "PID " << pid << " Page Table\n";
+    cout << "PID " << pid << " Page Table";
+    if (proc.page_frames > 1)
+        cout << " (" << proc.page_bytes << "B pages, frame = first of " << proc.page_frames << ")";
+    cout << "\n";
     cout << "Page\tValid\tFrame\n";
 
-    for (int i = 0; i < proc.num_pages; i++) {
+    for (long long i = 0; i < proc.num_pages; i++) {
         cout << i << "\t"
             << proc.table[i].valid << "\t"
             << proc.table[i].frame << "\n";
@@ -157,22 +638,55 @@ void dump_page_table(int pid) {
 }
 
 bool any_vm_initialized() {
-    return !page_tables.empty();
+    return !vm_state.page_tables.empty();
 }
 
 vector<int> get_initialized_pids() {
     vector<int> pids;
-    for (auto &pt : page_tables) {
+    for (auto &pt : vm_state.page_tables) {
         pids.push_back(pt.first);
     }
     return pids;
 }
 
 int get_used_frames(int pid) {
-    int used = 0;
-    for (auto &pte : page_tables[pid].table)
-        if (pte.valid) used++;
-    return used;
+    return vm_state.page_tables[pid].resident;
+}
+
+// Frame backing (pid, vaddr), or -1 if that page is not resident.
+static int resident_frame(int pid, long long vaddr) {
+    auto it = vm_state.page_tables.find(pid);
+    if (it == vm_state.page_tables.end())
+        return -1;
+
+    if (vaddr < 0 || it->second.page_bytes == 0)
+        return -1;
+
+    long long page = vaddr / it->second.page_bytes;
+    if (page >= it->second.num_pages)
+        return -1;
+
+    PageTableEntry *pte = find_pte(it->second, page, false, false);
+    if (!pte || !pte->valid)
+        return -1;
+    return pte->frame;
+}
+
+// Pins the frame behind a resident page so it cannot be evicted.
+bool vm_pin(int pid, long long vaddr) {
+    int f = resident_frame(pid, vaddr);
+    if (f == -1)
+        return false;
+    vm_state.frames[f].pin_count++;
+    return true;
+}
+
+bool vm_unpin(int pid, long long vaddr) {
+    int f = resident_frame(pid, vaddr);
+    if (f == -1 || vm_state.frames[f].pin_count == 0)
+        return false;
+    vm_state.frames[f].pin_count--;
+    return true;
 }
 
 
@@ -180,5 +694,51 @@ int get_total_frames() {
     return NUM_FRAMES;
 }
 
-int get_page_hits() { return page_hits; }
-int get_page_faults() { return page_faults; }
\ No newline at end of file
+int get_page_hits() { return vm_state.page_hits; }
+int get_page_faults() { return vm_state.page_faults; }
+int get_dirty_writebacks() { return vm_state.dirty_writebacks; }
+
+long long get_page_walk_refs() { return vm_state.page_walk_refs; }
+void set_page_walk_hook(void (*hook)(int)) { walk_hook = hook; }
+bool page_walk_hook_set() { return walk_hook != nullptr; }
+static VmState saved_vm;
+
+static Tlb *empty_tlb(const Tlb &t) {
+    return new Tlb(t.get_entries(), t.get_associativity(), t.get_policy());
+}
+
+// Moves rather than copies, so nothing pointing into the live state (the
+// ARC ghost lists) is duplicated.
+void begin_vm_scratch() {
+    saved_vm = std::move(vm_state);
+    vm_state = VmState();
+    init_frames(vm_state);
+
+    // Same TLB geometry and policy, empty.
+    if (saved_vm.l1_tlb)
+        vm_state.l1_tlb.reset(empty_tlb(*saved_vm.l1_tlb));
+    if (saved_vm.l2_tlb)
+        vm_state.l2_tlb.reset(empty_tlb(*saved_vm.l2_tlb));
+
+    // Same processes and table shapes, nothing mapped.
+    for (auto &p : saved_vm.page_tables) {
+        const ProcessVM &old = p.second;
+        ProcessVM vm;
+        vm.num_pages = old.num_pages;
+        vm.page_bytes = old.page_bytes;
+        vm.page_frames = old.page_frames;
+        vm.resident = 0;
+        vm.levels = old.levels;
+        vm.level_bits = old.level_bits;
+        if (vm.levels == 0)
+            vm.table.assign(vm.num_pages, {false, -1, 0});
+        else
+            new_inner(vm);
+        vm_state.page_tables[p.first] = std::move(vm);
+    }
+}
+
+void end_vm_scratch() {
+    vm_state = std::move(saved_vm);
+    saved_vm = VmState();
+}
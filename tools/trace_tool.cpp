@@ -0,0 +1,188 @@
+// Builds and inspects binary access traces for the simulator's
+// 'trace' command, and decodes its binary event logs.
+//
+//   trace_tool encode <in.txt> <out.bin>    text lines "pid vaddr [r|w] [thread]"
+//   trace_tool decode <in.bin>              print records as text
+//   trace_tool gen <out.bin> <records> <pids> <vsize> [seed] [threads]
+//                                           synthetic trace: sequential
+//                                           runs mixed with random jumps,
+//                                           one cursor per pid and thread
+//   trace_tool events <log.bin>             print an event log written
+//                                           with 'verbosity trace <file>'
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../include/trace.h"
+#include "../include/events.h"
+
+using namespace std;
+
+class TraceWriter {
+    FILE *out;
+    vector<TraceRecord> buf;
+    uint64_t count = 0;
+
+public:
+    explicit TraceWriter(FILE *f) : out(f) {
+        TraceHeader h;
+        memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+        h.count = 0;
+        fwrite(&h, sizeof(h), 1, out);
+        buf.reserve(1 << 16);
+    }
+
+    void add(uint32_t pid, uint64_t vaddr, bool write, uint32_t thread = 0) {
+        buf.push_back({vaddr, pid, (thread << TRACE_THREAD_SHIFT) | (write ? (uint32_t)TRACE_WRITE : 0u)});
+        if (buf.size() == buf.capacity())
+            flush();
+    }
+
+    void flush() {
+        fwrite(buf.data(), sizeof(TraceRecord), buf.size(), out);
+        count += buf.size();
+        buf.clear();
+    }
+
+    // Writes the final record count into the header.
+    void finish() {
+        flush();
+        fseek(out, offsetof(TraceHeader, count), SEEK_SET);
+        fwrite(&count, sizeof(count), 1, out);
+        fclose(out);
+    }
+
+    uint64_t written() const { return count + buf.size(); }
+};
+
+static FILE *create(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        cerr << "Cannot create " << path << "\n";
+    return f;
+}
+
+static int encode(const char *in_path, const char *out_path) {
+    ifstream in(in_path);
+    if (!in) {
+        cerr << "Cannot open " << in_path << "\n";
+        return 1;
+    }
+    FILE *f = create(out_path);
+    if (!f) return 1;
+
+    TraceWriter w(f);
+    string line;
+    int lineno = 0;
+    while (getline(in, line)) {
+        lineno++;
+        istringstream ss(line);
+        uint32_t pid;
+        uint64_t vaddr;
+        string rw;
+        uint32_t thread = 0;
+        ss >> ws;
+        if (ss.eof() || ss.peek() == '#')
+            continue;
+        if (!(ss >> pid >> vaddr)) {
+            cerr << in_path << ":" << lineno << ": expected 'pid vaddr [r|w] [thread]'\n";
+            return 1;
+        }
+        ss >> rw >> thread;
+        if (thread > 0xFFFF) {
+            cerr << in_path << ":" << lineno << ": thread id must be below 65536\n";
+            return 1;
+        }
+        w.add(pid, vaddr, rw == "w", thread);
+    }
+    w.finish();
+    cout << w.written() << " records written to " << out_path << "\n";
+    return 0;
+}
+
+static int decode(const char *path) {
+    TraceFile t;
+    if (!t.open(path)) return 1;
+    for (const TraceRecord &r : t) {
+        cout << r.pid << " " << r.vaddr << " " << ((r.flags & TRACE_WRITE) ? "w" : "r");
+        if (trace_thread(r))
+            cout << " " << trace_thread(r);
+        cout << "\n";
+    }
+    return 0;
+}
+
+static int gen(const char *path, uint64_t n, uint32_t pids, uint64_t vsize, unsigned seed,
+               uint32_t threads) {
+    FILE *f = create(path);
+    if (!f) return 1;
+
+    mt19937_64 rng(seed);
+    vector<uint64_t> cursor((size_t)pids * threads, 0);
+    TraceWriter w(f);
+
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t pid = 1 + rng() % pids;
+        uint32_t thread = threads > 1 ? rng() % threads : 0;
+        uint64_t &c = cursor[(size_t)(pid - 1) * threads + thread];
+
+        // Mostly walk forward in 8-byte steps; sometimes jump.
+        if (rng() % 16 == 0)
+            c = rng() % vsize;
+        else
+            c = (c + 8) % vsize;
+
+        w.add(pid, c, rng() % 4 == 0, thread);
+    }
+    w.finish();
+    cout << w.written() << " records written to " << path << "\n";
+    return 0;
+}
+
+static int events(const char *path) {
+    FILE *f = fopen(path, "rb");
+    char magic[8];
+    if (!f || fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+        memcmp(magic, EVENT_MAGIC, sizeof(magic)) != 0) {
+        cerr << "Not an event log: " << path << "\n";
+        if (f) fclose(f);
+        return 1;
+    }
+
+    vector<EventRecord> buf(1 << 16);
+    size_t n;
+    while ((n = fread(buf.data(), sizeof(EventRecord), buf.size(), f)) > 0)
+        for (size_t i = 0; i < n; i++)
+            format_event(cout, buf[i]);
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    string cmd = argc > 1 ? argv[1] : "";
+
+    if (cmd == "encode" && argc == 4)
+        return encode(argv[2], argv[3]);
+    if (cmd == "decode" && argc == 3)
+        return decode(argv[2]);
+    if (cmd == "events" && argc == 3)
+        return events(argv[2]);
+    if (cmd == "gen" && argc >= 6 && argc <= 8 && atoi(argv[4]) > 0 && strtoull(argv[5], nullptr, 10) > 0 &&
+        (argc < 8 || (atoi(argv[7]) > 0 && atoi(argv[7]) <= 0x10000)))
+        return gen(argv[2], strtoull(argv[3], nullptr, 10), (uint32_t)atoi(argv[4]),
+                   strtoull(argv[5], nullptr, 10), argc >= 7 ? (unsigned)atoi(argv[6]) : 1,
+                   argc == 8 ? (uint32_t)atoi(argv[7]) : 1);
+
+    cerr << "usage: trace_tool encode <in.txt> <out.bin>\n"
+         << "       trace_tool decode <in.bin>\n"
+         << "       trace_tool gen <out.bin> <records> <pids> <vsize> [seed] [threads]\n"
+         << "       trace_tool events <log.bin>\n";
+    return 1;
+}